@@ -0,0 +1,247 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file bench_crc.c
+	\brief Mesure, en cycles par byte, des trois méthodes de chaque CRC de lib/crc.c
+	\author Iouri Savard Colbert
+
+	Ce programme roule sur le microcontrôleur. Il se compile avec lib/crc.c,
+	lib/fixed.c, lib/utils.c, lib/uart.c et lib/fifo.c, avec
+	CRC_ENABLE_ALL_METHODS définie dans lib/crc.h, et écrit ses résultats sur le
+	UART (voir uart_init() pour la vitesse).
+
+	Chaque fonction _update() est appelée sur les BUFFER_SIZE bytes d'un buffer,
+	interruptions désactivées, et le timer 1 compte les cycles (prescaler de 1). Le
+	coût de la même boucle avec une fonction vide est soustrait, ce qui laisse le
+	coût de l'appel et du calcul. Le résultat affiché est le nombre de cycles
+	divisé par BUFFER_SIZE.
+
+	Le CRC de "123456789" est aussi affiché pour chaque fonction, pour vérifier
+	qu'elles donnent toutes le même résultat.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "crc.h"
+#include "fixed.h"
+#include "utils.h"
+#include "uart.h"
+
+#ifndef CRC_ENABLE_ALL_METHODS
+#error "CRC_ENABLE_ALL_METHODS doit être définie dans crc.h"
+#endif
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+/* Le timer 1 fait 16 bits. Le CRC-32 bitwise, le plus lent, prend quelques
+centaines de cycles par byte : 64 bytes tiennent dans 65535 cycles. */
+#define BUFFER_SIZE 64
+
+#define CHECK_STRING "123456789"
+#define CHECK_LENGTH 9
+
+#define START_MEASURE() \
+	do{ \
+		TCNT1 = 0; \
+	}while(0)
+
+#define STOP_MEASURE(cycles) \
+	do{ \
+		(cycles) = TCNT1; \
+	}while(0)
+
+/* Mesure function sur tout le buffer et calcule le CRC de CHECK_STRING */
+#define MEASURE(result, function, type, init) \
+	do{ \
+		uint8_t i; \
+		type crc = (init); \
+		START_MEASURE(); \
+		for(i = 0; i < BUFFER_SIZE; i++){ \
+			crc = function(crc, buffer[i]); \
+		} \
+		STOP_MEASURE((result)->cycles); \
+		(result)->cycles -= overhead; \
+		sink = crc; \
+		crc = (init); \
+		for(i = 0; i < CHECK_LENGTH; i++){ \
+			crc = function(crc, CHECK_STRING[i]); \
+		} \
+		(result)->check = crc; \
+	}while(0)
+
+
+/******************************************************************************
+Typedef
+******************************************************************************/
+
+typedef struct{
+
+	uint16_t cycles;
+	uint32_t check;
+
+}result_t;
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+/* volatile pour que le compilateur ne puisse pas faire le calcul d'avance */
+static volatile uint8_t buffer[BUFFER_SIZE];
+static volatile uint32_t sink;
+static uint16_t overhead;
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static uint8_t empty(uint8_t crc, uint8_t byte);
+static void print_result(char* name, result_t* bitwise, result_t* nibble, result_t* table);
+static void print_cycles_per_byte(uint16_t cycles);
+
+
+/******************************************************************************
+Main
+******************************************************************************/
+
+int main(void){
+
+	result_t bitwise;
+	result_t nibble;
+	result_t table;
+	result_t empty_result;
+	uint8_t i;
+
+	for(i = 0; i < BUFFER_SIZE; i++){
+
+		buffer[i] = i * 37 + 11;
+	}
+
+	uart_init();
+	uart_set_tx_policy(UART_POLICY_BLOCK);
+	sei();
+
+	uart_put_string("\n\rCRC : bitwise, nibble, table (cycles par byte) [CRC de \"" CHECK_STRING "\"]\n\r");
+
+	/* Les mesures se font sans interruption, mais le UART en a besoin pour vider
+	son buffer entre les lignes */
+	cli();
+
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+
+	/* Le coût de la boucle elle-même */
+	overhead = 0;
+	MEASURE(&empty_result, empty, uint8_t, 0);
+	overhead = empty_result.cycles;
+
+	MEASURE(&bitwise, crc8_update_bitwise, uint8_t, CRC8_INIT);
+	MEASURE(&nibble, crc8_update_nibble, uint8_t, CRC8_INIT);
+	MEASURE(&table, crc8_update_table, uint8_t, CRC8_INIT);
+	print_result("crc8", &bitwise, &nibble, &table);
+
+	MEASURE(&bitwise, crc16_modbus_update_bitwise, uint16_t, CRC16_MODBUS_INIT);
+	MEASURE(&nibble, crc16_modbus_update_nibble, uint16_t, CRC16_MODBUS_INIT);
+	MEASURE(&table, crc16_modbus_update_table, uint16_t, CRC16_MODBUS_INIT);
+	print_result("crc16_modbus", &bitwise, &nibble, &table);
+
+	MEASURE(&bitwise, crc16_ccitt_update_bitwise, uint16_t, CRC16_CCITT_INIT);
+	MEASURE(&nibble, crc16_ccitt_update_nibble, uint16_t, CRC16_CCITT_INIT);
+	MEASURE(&table, crc16_ccitt_update_table, uint16_t, CRC16_CCITT_INIT);
+	print_result("crc16_ccitt", &bitwise, &nibble, &table);
+
+	MEASURE(&bitwise, crc32_update_bitwise, uint32_t, CRC32_INIT);
+	MEASURE(&nibble, crc32_update_nibble, uint32_t, CRC32_INIT);
+	MEASURE(&table, crc32_update_table, uint32_t, CRC32_INIT);
+	bitwise.check = CRC32_FINAL(bitwise.check);
+	nibble.check = CRC32_FINAL(nibble.check);
+	table.check = CRC32_FINAL(table.check);
+	print_result("crc32", &bitwise, &nibble, &table);
+
+	sei();
+
+	while(1){
+
+	}
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* Sert à mesurer le coût d'une boucle d'appels qui ne font rien */
+static uint8_t __attribute__((noinline)) empty(uint8_t crc, uint8_t byte){
+
+	return crc ^ byte;
+}
+
+
+static void print_result(char* name, result_t* bitwise, result_t* nibble, result_t* table){
+
+	char string[12];
+
+	sei();
+
+	uart_put_string(name);
+	uart_put_string(" : ");
+
+	print_cycles_per_byte(bitwise->cycles);
+	uart_put_string(", ");
+	print_cycles_per_byte(nibble->cycles);
+	uart_put_string(", ");
+	print_cycles_per_byte(table->cycles);
+
+	uart_put_string(" [");
+	uint32_to_hex_string(string, bitwise->check);
+	uart_put_string(string);
+	uart_put_string(" ");
+	uint32_to_hex_string(string, nibble->check);
+	uart_put_string(string);
+	uart_put_string(" ");
+	uint32_to_hex_string(string, table->check);
+	uart_put_string(string);
+	uart_put_string("]\n\r");
+
+	/* On attend que tout soit parti pour que le UART ne dérange pas la mesure suivante */
+	while(uart_get_tx_free_space() < UART_TX_BUFFER_SIZE){
+
+	}
+
+	cli();
+}
+
+
+static void print_cycles_per_byte(uint16_t cycles){
+
+	char string[FIXED_STRING_SIZE];
+
+	/* cycles / BUFFER_SIZE, avec une décimale */
+	q16_16_to_string(string, (q16_16_t)cycles * (Q16_16_ONE / BUFFER_SIZE), 1);
+	uart_put_string(string);
+}
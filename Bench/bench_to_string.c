@@ -0,0 +1,423 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file bench_to_string.c
+	\brief Mesure, en cycles, des fonctions *_to_string() de lib/utils.c
+	\author Iouri Savard Colbert
+
+	Ce programme roule sur le microcontrôleur. Il se compile avec lib/utils.c,
+	lib/uart.c et lib/fifo.c, et écrit ses résultats sur le UART (voir
+	uart_init() pour la vitesse).
+
+	Chaque fonction est appelée avec la même liste de valeurs, interruptions
+	désactivées, et le timer 1 compte les cycles (prescaler de 1). Le coût d'une
+	mesure vide est soustrait. Pour chaque fonction, le pire cas et la moyenne sur
+	la liste sont affichés, pour l'ancienne version (divisions et multiplications
+	par des puissances de 10, copiée ici telle qu'elle était) et pour la nouvelle.
+
+	Les anciennes versions hexadécimales n'existent pas : leur code n'a pas changé.
+
+	Avant les mesures, quelques conversions signées dont la magnitude dépasse
+	16 bits sont vérifiées. Elles ne peuvent pas l'être sur l'ordinateur, où un
+	int fait 32 bits. Une erreur est affichée sur le UART.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "utils.h"
+#include "uart.h"
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+#define NB_VALUES (sizeof(values) / sizeof(values[0]))
+
+/* Le timer 1 fait 16 bits, une mesure ne doit donc pas dépasser 65535 cycles.
+L'ancien uint32_to_string(), le plus lent, fait 20 divisions de 32 bits, soit
+quelques milliers de cycles. */
+#define START_MEASURE() \
+	do{ \
+		TCNT1 = 0; \
+	}while(0)
+
+#define STOP_MEASURE(cycles) \
+	do{ \
+		(cycles) = TCNT1; \
+	}while(0)
+
+/* Mesure function(buffer, values[i] casté en type) pour toutes les valeurs */
+#define MEASURE(result, function, type) \
+	do{ \
+		uint8_t i; \
+		uint16_t cycles; \
+		(result)->worst = 0; \
+		(result)->total = 0; \
+		for(i = 0; i < NB_VALUES; i++){ \
+			type value = (type)values[i]; \
+			START_MEASURE(); \
+			function(buffer, value); \
+			STOP_MEASURE(cycles); \
+			cycles -= overhead; \
+			if(cycles > (result)->worst){ \
+				(result)->worst = cycles; \
+			} \
+			(result)->total += cycles; \
+		} \
+	}while(0)
+
+/* Même chose pour les versions alignées, qui prennent une largeur et un padding */
+#define MEASURE_ALIGNED(result, function, type) \
+	do{ \
+		uint8_t i; \
+		uint16_t cycles; \
+		(result)->worst = 0; \
+		(result)->total = 0; \
+		for(i = 0; i < NB_VALUES; i++){ \
+			type value = (type)values[i]; \
+			START_MEASURE(); \
+			function(buffer, value, 8, ' '); \
+			STOP_MEASURE(cycles); \
+			cycles -= overhead; \
+			if(cycles > (result)->worst){ \
+				(result)->worst = cycles; \
+			} \
+			(result)->total += cycles; \
+		} \
+	}while(0)
+
+
+/******************************************************************************
+Typedef
+******************************************************************************/
+
+typedef struct{
+
+	uint16_t worst;
+	uint32_t total;
+
+}result_t;
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+/* volatile pour que le compilateur ne puisse pas faire la conversion d'avance */
+static volatile uint32_t values[] = {
+
+	0, 7, 42, 99, 100, 127, 200, 255,
+	1000, 9999, 32767, 40000, 65535,
+	100000, 1234567, 99999999, 2147483647, 4000000000, 4294967295,
+
+	// Négatifs une fois castés en int32_t, au-delà de 16 bits
+	(uint32_t)-100000L, (uint32_t)-32769L, 0x80000000
+};
+
+static char buffer[12];
+static uint16_t overhead;
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static uint8_t old_uint8_to_string(char* out_string, uint8_t number);
+static uint8_t old_uint16_to_string(char* out_string, uint16_t number);
+static uint8_t old_uint32_to_string(char* out_string, uint32_t number);
+static uint8_t old_int8_to_string(char* out_string, int8_t number);
+static uint8_t old_int16_to_string(char* out_string, int16_t number);
+static uint8_t old_int32_to_string(char* out_string, int32_t number);
+static void empty(char* out_string, uint32_t number);
+static void check_string(const char* expected);
+static void print_result(char* name, result_t* old_result, result_t* new_result);
+static void print_cycles(result_t* result);
+
+
+/******************************************************************************
+Main
+******************************************************************************/
+
+int main(void){
+
+	result_t old_result;
+	result_t new_result;
+	uint8_t i;
+	uint16_t cycles;
+
+	uart_init();
+	uart_set_tx_policy(UART_POLICY_BLOCK);
+	sei();
+
+	int32_to_string(buffer, -100000L);
+	check_string("-0000100000");
+
+	int32_to_string(buffer, INT32_MIN);
+	check_string("-2147483648");
+
+	int16_to_string(buffer, INT16_MIN);
+	check_string("-32768");
+
+	int32_to_string_unpadded(buffer, -100000L);
+	check_string("-100000");
+
+	uart_put_string("\n\rfonction : ancien pire/moyen, nouveau pire/moyen (cycles)\n\r");
+
+	/* Les mesures se font sans interruption, mais le UART en a besoin pour vider
+	son buffer entre les lignes */
+	cli();
+
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+
+	/* Le coût de la mesure elle-même */
+	overhead = 0xFFFF;
+
+	for(i = 0; i < NB_VALUES; i++){
+
+		START_MEASURE();
+		empty(buffer, values[i]);
+		STOP_MEASURE(cycles);
+
+		if(cycles < overhead){
+
+			overhead = cycles;
+		}
+	}
+
+	MEASURE(&old_result, old_uint8_to_string, uint8_t);
+	MEASURE(&new_result, uint8_to_string, uint8_t);
+	print_result("uint8_to_string", &old_result, &new_result);
+
+	MEASURE(&old_result, old_uint16_to_string, uint16_t);
+	MEASURE(&new_result, uint16_to_string, uint16_t);
+	print_result("uint16_to_string", &old_result, &new_result);
+
+	MEASURE(&old_result, old_uint32_to_string, uint32_t);
+	MEASURE(&new_result, uint32_to_string, uint32_t);
+	print_result("uint32_to_string", &old_result, &new_result);
+
+	MEASURE(&old_result, old_int8_to_string, int8_t);
+	MEASURE(&new_result, int8_to_string, int8_t);
+	print_result("int8_to_string", &old_result, &new_result);
+
+	MEASURE(&old_result, old_int16_to_string, int16_t);
+	MEASURE(&new_result, int16_to_string, int16_t);
+	print_result("int16_to_string", &old_result, &new_result);
+
+	MEASURE(&old_result, old_int32_to_string, int32_t);
+	MEASURE(&new_result, int32_to_string, int32_t);
+	print_result("int32_to_string", &old_result, &new_result);
+
+	MEASURE(&new_result, uint32_to_string_unpadded, uint32_t);
+	print_result("uint32_to_string_unpadded", NULL, &new_result);
+
+	MEASURE(&new_result, int32_to_string_unpadded, int32_t);
+	print_result("int32_to_string_unpadded", NULL, &new_result);
+
+	MEASURE_ALIGNED(&new_result, uint32_to_string_aligned, uint32_t);
+	print_result("uint32_to_string_aligned", NULL, &new_result);
+
+	MEASURE_ALIGNED(&new_result, int32_to_string_aligned, int32_t);
+	print_result("int32_to_string_aligned", NULL, &new_result);
+
+	MEASURE(&new_result, uint8_to_hex_string, uint8_t);
+	print_result("uint8_to_hex_string", NULL, &new_result);
+
+	MEASURE(&new_result, uint16_to_hex_string, uint16_t);
+	print_result("uint16_to_hex_string", NULL, &new_result);
+
+	MEASURE(&new_result, uint32_to_hex_string, uint32_t);
+	print_result("uint32_to_hex_string", NULL, &new_result);
+
+	sei();
+
+	while(1){
+
+	}
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* Les anciennes versions, avant le passage aux multiplications par l'inverse */
+static uint8_t __attribute__((noinline)) old_uint8_to_string(char* out_string, uint8_t number){
+
+	uint8_t anti_rest;
+	uint8_t string_index = 0;
+	uint8_t power_of_ten = 100;
+
+	while(power_of_ten > 0){
+
+		anti_rest = number / power_of_ten;
+		out_string[string_index] = uint_to_char(anti_rest);
+		number -= anti_rest * power_of_ten;
+		string_index++;
+		power_of_ten /= 10;
+	}
+
+	out_string[string_index] = '\0';
+
+	return string_index;
+}
+
+
+static uint8_t __attribute__((noinline)) old_uint16_to_string(char* out_string, uint16_t number){
+
+	uint8_t anti_rest;
+	uint8_t string_index = 0;
+	uint16_t power_of_ten = 10000;
+
+	while(power_of_ten > 0){
+
+		anti_rest = number / power_of_ten;
+		out_string[string_index] = uint_to_char(anti_rest);
+		number -= anti_rest * power_of_ten;
+		string_index++;
+		power_of_ten /= 10;
+	}
+
+	out_string[string_index] = '\0';
+
+	return string_index;
+}
+
+
+static uint8_t __attribute__((noinline)) old_uint32_to_string(char* out_string, uint32_t number){
+
+	uint8_t anti_rest;
+	uint8_t string_index = 0;
+	uint32_t power_of_ten = 1000000000;
+
+	while(power_of_ten > 0){
+
+		anti_rest = number / power_of_ten;
+		out_string[string_index] = uint_to_char(anti_rest);
+		number -= anti_rest * power_of_ten;
+		string_index++;
+		power_of_ten /= 10;
+	}
+
+	out_string[string_index] = '\0';
+
+	return string_index;
+}
+
+
+static uint8_t __attribute__((noinline)) old_int8_to_string(char* out_string, int8_t number){
+
+	out_string[0] = (number < 0) ? '-' : '+';
+
+	return old_uint8_to_string(&out_string[1], (uint8_t)abs(number)) + 1;
+}
+
+
+static uint8_t __attribute__((noinline)) old_int16_to_string(char* out_string, int16_t number){
+
+	out_string[0] = (number < 0) ? '-' : '+';
+
+	return old_uint16_to_string(&out_string[1], (uint16_t)abs(number)) + 1;
+}
+
+
+static uint8_t __attribute__((noinline)) old_int32_to_string(char* out_string, int32_t number){
+
+	out_string[0] = (number < 0) ? '-' : '+';
+
+	return old_uint32_to_string(&out_string[1], (uint32_t)abs(number)) + 1;
+}
+
+
+/* Sert à mesurer le coût d'un appel qui ne fait rien */
+static void __attribute__((noinline)) empty(char* out_string, uint32_t number){
+
+	out_string[0] = (char)number;
+}
+
+
+/* Compare le contenu de buffer à expected et affiche une erreur s'ils diffèrent */
+static void check_string(const char* expected){
+
+	uint8_t i = 0;
+
+	while((buffer[i] == expected[i]) && (expected[i] != '\0')){
+
+		i++;
+	}
+
+	if(buffer[i] != expected[i]){
+
+		uart_put_string("\n\rERREUR : ");
+		uart_put_string(buffer);
+		uart_put_string(" au lieu de ");
+		uart_put_string((char*)expected);
+	}
+}
+
+
+/* old_result à NULL s'il n'y a pas d'ancienne version */
+static void print_result(char* name, result_t* old_result, result_t* new_result){
+
+	sei();
+
+	uart_put_string(name);
+	uart_put_string(" : ");
+
+	if(old_result != NULL){
+
+		print_cycles(old_result);
+	}
+
+	else{
+
+		uart_put_string("-");
+	}
+
+	uart_put_string(", ");
+	print_cycles(new_result);
+	uart_put_string("\n\r");
+
+	/* On attend que tout soit parti pour que le UART ne dérange pas la mesure suivante */
+	while(uart_get_tx_free_space() < UART_TX_BUFFER_SIZE){
+
+	}
+
+	cli();
+}
+
+
+static void print_cycles(result_t* result){
+
+	char string[12];
+
+	uint32_to_string_unpadded(string, result->worst);
+	uart_put_string(string);
+	uart_put_string("/");
+
+	uint32_to_string_unpadded(string, result->total / NB_VALUES);
+	uart_put_string(string);
+}
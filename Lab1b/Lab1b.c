@@ -45,6 +45,9 @@ int main(void){
 			lcd_write_string("DELs hors       fonction"); // On écrit sur le LCD
 		}
 
+		lcd_refresh(); // Avec LCD_ENABLE_FRAMEBUFFER, seules les cases qui ont changé
+					   // sont envoyées au LCD. Sinon, cette fonction ne fait rien.
+
 		_delay_ms(100); // On attend un petit délai sinon la boucle irait trop vite
 	}
 }
@@ -0,0 +1,332 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file bargraph.c
+	\brief Barres graphes et jauges pour le LCD
+	\author Iouri Savard Colbert
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <avr/pgmspace.h>
+
+#include "bargraph.h"
+#include "glyph.h"
+#include "lcd.h"
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+#define COL_PIXELS 5
+#define ROW_PIXELS HD44780_CGRAM_HEIGHT
+
+/* Codes de la ROM du HD44780, écrits avec lcd_write_code() */
+#define EMPTY_CHAR ' '
+#define FULL_CHAR 0xFF
+
+/* L'aiguille d'une jauge qui n'a pas de place en CGRAM */
+#define NEEDLE_CHAR '|'
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+/* Le bit 4 est la colonne de gauche */
+static const uint8_t horizontal_bitmaps[COL_PIXELS - 1][HD44780_CGRAM_HEIGHT] PROGMEM = {
+
+	{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+	{0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18},
+	{0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C, 0x1C},
+	{0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E, 0x1E},
+};
+
+static const uint8_t vertical_bitmaps[ROW_PIXELS - 1][HD44780_CGRAM_HEIGHT] PROGMEM = {
+
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F},
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F},
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F},
+	{0x00, 0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F},
+	{0x00, 0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+	{0x00, 0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+	{0x00, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F, 0x1F},
+};
+
+static const uint8_t needle_bitmaps[COL_PIXELS][HD44780_CGRAM_HEIGHT] PROGMEM = {
+
+	{0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10},
+	{0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08},
+	{0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04},
+	{0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02},
+	{0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01},
+};
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static uint8_t cell_pixels(const bargraph_t* bar);
+static uint8_t cell_fill(const bargraph_t* bar, uint8_t level, uint8_t cell);
+static const uint8_t* fill_to_bitmap(const bargraph_t* bar, uint8_t fill);
+static uint8_t fill_to_code(const bargraph_t* bar, uint8_t fill);
+static void draw(bargraph_t* bar, uint8_t level, bool force);
+
+
+/******************************************************************************
+Global functions
+******************************************************************************/
+
+void bargraph_init(bargraph_t* bar, bargraph_style_e style, uint8_t col, uint8_t row, uint8_t length){
+
+	bar->style = style;
+	bar->col = col;
+	bar->row = row;
+	bar->length = length;
+	bar->level = 0;
+	bar->glyph = GLYPH_NONE;
+
+	draw(bar, 0, TRUE);
+}
+
+
+uint8_t bargraph_get_resolution(const bargraph_t* bar){
+
+	// L'aiguille a une position de moins que la barre a de niveaux, la barre
+	// vide n'ayant pas d'équivalent
+	if(bar->style == BARGRAPH_GAUGE){
+
+		return bar->length * COL_PIXELS - 1;
+	}
+
+	return bar->length * cell_pixels(bar);
+}
+
+
+void bargraph_set_level(bargraph_t* bar, uint8_t level){
+
+	uint8_t resolution;
+
+	resolution = bargraph_get_resolution(bar);
+
+	if(level > resolution){
+
+		level = resolution;
+	}
+
+	if(level != bar->level){
+
+		draw(bar, level, FALSE);
+	}
+}
+
+
+void bargraph_set_value(bargraph_t* bar, uint16_t value, uint16_t max){
+
+	uint32_t level;
+
+	if(max == 0){
+
+		return;
+	}
+
+	if(value > max){
+
+		value = max;
+	}
+
+	// Arrondi au pixel le plus proche
+	level = ((uint32_t)value * bargraph_get_resolution(bar) + (max / 2)) / max;
+
+	bargraph_set_level(bar, (uint8_t)level);
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+static uint8_t cell_pixels(const bargraph_t* bar){
+
+	if(bar->style == BARGRAPH_VERTICAL){
+
+		return ROW_PIXELS;
+	}
+
+	return COL_PIXELS;
+}
+
+
+/* Le contenu d'une case pour un niveau donné. Pour une barre, c'est le nombre de
+pixels remplis. Pour une jauge, c'est 0 si l'aiguille n'est pas dans la case,
+sinon sa position dans la case + 1. */
+static uint8_t cell_fill(const bargraph_t* bar, uint8_t level, uint8_t cell){
+
+	uint8_t pixels;
+	uint8_t start;
+
+	pixels = cell_pixels(bar);
+	start = cell * pixels;
+
+	if(bar->style == BARGRAPH_GAUGE){
+
+		if((level >= start) && (level < start + pixels)){
+
+			return level - start + 1;
+		}
+
+		return 0;
+	}
+
+	if(level <= start){
+
+		return 0;
+	}
+
+	if(level - start >= pixels){
+
+		return pixels;
+	}
+
+	return level - start;
+}
+
+
+/* Le dessin d'une case partiellement remplie, NULL si la case est vide ou pleine
+et s'affiche avec un caractère de la ROM */
+static const uint8_t* fill_to_bitmap(const bargraph_t* bar, uint8_t fill){
+
+	if(fill == 0){
+
+		return NULL;
+	}
+
+	switch(bar->style){
+	case BARGRAPH_GAUGE:
+		return needle_bitmaps[fill - 1];
+
+	case BARGRAPH_VERTICAL:
+		if(fill == ROW_PIXELS){
+
+			return NULL;
+		}
+
+		return vertical_bitmaps[fill - 1];
+
+	default:
+		if(fill == COL_PIXELS){
+
+			return NULL;
+		}
+
+		return horizontal_bitmaps[fill - 1];
+	}
+}
+
+
+/* Le code à écrire pour une case. Une case partielle utilise la place réservée
+par la barre. */
+static uint8_t fill_to_code(const bargraph_t* bar, uint8_t fill){
+
+	if(fill == 0){
+
+		return EMPTY_CHAR;
+	}
+
+	if(fill_to_bitmap(bar, fill) == NULL){
+
+		return FULL_CHAR;
+	}
+
+	if(bar->glyph != GLYPH_NONE){
+
+		return bar->glyph;
+	}
+
+	// Toutes les places de la CGRAM sont réservées, on arrondi
+	if(bar->style == BARGRAPH_GAUGE){
+
+		return NEEDLE_CHAR;
+	}
+
+	if(fill * 2 >= cell_pixels(bar)){
+
+		return FULL_CHAR;
+	}
+
+	return EMPTY_CHAR;
+}
+
+
+static void draw(bargraph_t* bar, uint8_t level, bool force){
+
+	uint8_t cell;
+	uint8_t old_fill;
+	uint8_t new_fill;
+	uint8_t old_glyph;
+	const uint8_t* bitmap;
+	uint8_t next_cell = 0xFF;
+
+	// La réservation de l'ancienne case partielle est rendue avant de réserver la
+	// nouvelle. Si le dessin ne change pas, il est retrouvé à la même place. S'il
+	// change, c'est que l'ancienne case partielle est réécrite plus bas.
+	old_glyph = bar->glyph;
+	glyph_release(bar->glyph);
+	bar->glyph = GLYPH_NONE;
+
+	for(cell = 0; cell < bar->length; cell++){
+
+		old_fill = cell_fill(bar, bar->level, cell);
+		new_fill = cell_fill(bar, level, cell);
+
+		// Il y a au plus une case partielle
+		bitmap = fill_to_bitmap(bar, new_fill);
+
+		if(bitmap != NULL){
+
+			bar->glyph = glyph_acquire_P(bitmap);
+		}
+
+		// Une case partielle qui n'a pas changé doit quand même être réécrite si
+		// son dessin a changé de place
+		if((force == TRUE) || (old_fill != new_fill) || ((bitmap != NULL) && (bar->glyph != old_glyph))){
+
+			if(bar->style == BARGRAPH_VERTICAL){
+
+				lcd_set_cursor_position(bar->col, bar->row - cell);
+			}
+
+			// Sur une rangée, le curseur avance tout seul d'une case à l'autre
+			else if(cell != next_cell){
+
+				lcd_set_cursor_position(bar->col + cell, bar->row);
+			}
+
+			lcd_write_code(fill_to_code(bar, new_fill));
+
+			next_cell = cell + 1;
+		}
+	}
+
+	bar->level = level;
+}
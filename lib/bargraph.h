@@ -0,0 +1,149 @@
+#ifndef BARGRAPH_H_INCLUDED
+#define BARGRAPH_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file bargraph.h
+	\brief Barres graphes et jauges pour le LCD
+	\author Iouri Savard Colbert
+
+	Une barre occupe plusieurs cases consécutives, sur une rangée (horizontale) ou
+	sur une colonne (verticale). Les cases partiellement remplies sont dessinées
+	en CGRAM à l'aide du module glyph, ce qui donne une résolution de 5 pixels par
+	case à l'horizontale et de 8 pixels par case à la verticale.
+
+	Chaque barre se souvient du dernier niveau affiché. Quand le niveau change,
+	seules les cases dont le remplissage a changé sont réécrites, ce qui donne
+	typiquement une ou deux cases par mise à jour. Une barre peut donc suivre une
+	lecture d'ADC à 50 Hz sans monopoliser le bus du LCD.
+
+	La jauge (BARGRAPH_GAUGE) est horizontale mais n'affiche qu'une aiguille d'un
+	pixel de large à la position du niveau plutôt qu'une barre pleine.
+
+	\code
+
+	bargraph_t adc_bar;
+
+	lcd_init();
+	glyph_init(NULL, 0);
+
+	bargraph_init(&adc_bar, BARGRAPH_HORIZONTAL, 0, 1, 16);
+
+	while(1){
+
+		bargraph_set_value(&adc_bar, adc_read(0), 255);
+	}
+
+	\endcode
+
+	Une barre n'affiche qu'un caractère personnalisé à la fois (sa case
+	partiellement remplie, ou l'aiguille) et le réserve avec glyph_acquire_P() tant
+	qu'il est à l'écran. Jusqu'à HD44780_NB_CGRAM_CHAR barres peuvent donc être
+	affichées en même temps, moins les places réservées ailleurs. Au-delà, la case
+	partielle d'une barre qui ne trouve pas de place est arrondie à une case vide
+	ou pleine (un '|' pour une jauge), jusqu'à ce qu'une place se libère.
+
+	Les dessins demandés avec glyph_get() ne sont pas réservés : les barres peuvent
+	reprendre leur place.
+
+	Les fonctions déplacent le curseur du LCD.
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include "utils.h"
+
+
+/* ----------------------------------------------------------------------------
+Defines et typedef
+---------------------------------------------------------------------------- */
+
+/**
+    \sa bargraph_init(bargraph_t* bar, bargraph_style_e style, uint8_t col, uint8_t row, uint8_t length)
+*/
+typedef enum{
+
+	BARGRAPH_HORIZONTAL,    ///< Se remplit de gauche à droite
+	BARGRAPH_VERTICAL,      ///< Se remplit de bas en haut
+	BARGRAPH_GAUGE          ///< Une aiguille qui se déplace de gauche à droite
+
+}bargraph_style_e;
+
+/**
+    \brief L'état d'une barre. Ses champs ne doivent pas être modifiés directement.
+*/
+typedef struct{
+
+	bargraph_style_e style;
+	uint8_t col;
+	uint8_t row;
+	uint8_t length;
+	uint8_t level;
+	uint8_t glyph;      // La place réservée en CGRAM, ou GLYPH_NONE
+
+}bargraph_t;
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Initialise une barre et l'affiche vide
+    \param[out] bar     La barre
+    \param[in]  style   Le style de la barre
+    \param[in]  col     La colonne de la première case (à gauche, ou en bas)
+    \param[in]  row     La rangée de la première case (à gauche, ou en bas)
+    \param[in]  length  Le nombre de cases
+
+	Une barre verticale monte à partir de la rangée row. glyph_init() doit avoir
+	été appelée avant.
+*/
+void bargraph_init(bargraph_t* bar, bargraph_style_e style, uint8_t col, uint8_t row, uint8_t length);
+
+/**
+    \brief Retourne le niveau maximal d'une barre, en pixels
+*/
+uint8_t bargraph_get_resolution(const bargraph_t* bar);
+
+/**
+    \brief Change le niveau d'une barre
+    \param[in,out]  bar     La barre
+    \param[in]      level   Le niveau, de 0 à bargraph_get_resolution(). Pour une
+	jauge, la position de l'aiguille à partir de 0.
+
+	Seules les cases qui changent sont réécrites. Si le niveau n'a pas changé,
+	rien n'est envoyé au LCD.
+*/
+void bargraph_set_level(bargraph_t* bar, uint8_t level);
+
+/**
+    \brief Change le niveau d'une barre à partir d'une valeur quelconque
+    \param[in,out]  bar     La barre
+    \param[in]      value   La valeur, de 0 à max
+    \param[in]      max     La valeur qui correspond à une barre pleine (ou à
+	l'aiguille complètement à droite)
+*/
+void bargraph_set_value(bargraph_t* bar, uint16_t value, uint16_t max);
+
+
+#endif // BARGRAPH_H_INCLUDED
@@ -0,0 +1,382 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file console.c
+	\brief Console de type journal sur le LCD, plus grande que l'écran
+	\author Iouri Savard Colbert
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include "console.h"
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+#if LCD_NB_ROW > 2
+#error "Le décalage de l'affichage du HD44780 ne fonctionne que sur un LCD d'une ou deux rangées"
+#endif
+
+#define BLANK_CHAR (' ')
+
+/* Décalage maximal de la fenêtre vers la droite */
+#define MAX_SHIFT (CONSOLE_LINE_SIZE - LCD_NB_COL)
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+/* L'anneau de lignes. first_line est la place de la plus ancienne. */
+static char lines[CONSOLE_NB_LINES][CONSOLE_LINE_SIZE];
+static uint8_t first_line;
+static uint8_t line_count;
+static uint8_t write_col;
+
+/* La ligne du journal affichée sur la rangée du haut et le décalage horizontal */
+static uint8_t view_top;
+static uint8_t view_shift;
+
+/* Ce qui est présentement en DDRAM */
+static char screen[LCD_NB_ROW][CONSOLE_LINE_SIZE];
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static void reset(void);
+static char* get_line(uint8_t line);
+static uint8_t bottom_top(void);
+static void append(char character);
+static void new_line(void);
+static void update_view(void);
+static void update_row(uint8_t row);
+static void fill(char* line, char character);
+
+
+/******************************************************************************
+Global functions
+******************************************************************************/
+
+void console_init(void){
+
+	hd44780_init(TRUE, FALSE, FALSE);
+
+	reset();
+}
+
+
+void console_clear(void){
+
+	// Efface aussi le décalage de l'affichage
+	hd44780_clear_display();
+
+	reset();
+}
+
+
+void console_write_char(char character){
+
+	append(character);
+
+	update_view();
+}
+
+
+void console_write_string(const char* string){
+
+	while(*string != '\0'){
+
+		append(*string);
+		string++;
+	}
+
+	update_view();
+}
+
+
+void console_scroll(lcd_shift_e shift){
+
+	switch(shift){
+	case LCD_SHIFT_UP:
+
+		if(view_top > 0){
+
+			view_top--;
+		}
+
+		break;
+
+	case LCD_SHIFT_DOWN:
+
+		if(view_top < bottom_top()){
+
+			view_top++;
+		}
+
+		break;
+
+	case LCD_SHIFT_TOP:
+
+		view_top = 0;
+
+		break;
+
+	case LCD_SHIFT_BOTTOM:
+
+		view_top = bottom_top();
+
+		break;
+
+	case LCD_SHIFT_RIGHT:
+
+		// Le texte se déplace vers la gauche pour montrer ce qui est à droite
+		if(view_shift < MAX_SHIFT){
+
+			hd44780_shift_display(HD44780_SHIFT_LEFT);
+			view_shift++;
+		}
+
+		break;
+
+	case LCD_SHIFT_LEFT:
+
+		if(view_shift > 0){
+
+			hd44780_shift_display(HD44780_SHIFT_RIGHT);
+			view_shift--;
+		}
+
+		break;
+
+	case LCD_SHIFT_START:
+
+		if(view_shift > 0){
+
+			hd44780_return_home();
+			view_shift = 0;
+		}
+
+		break;
+
+	case LCD_SHIFT_END:
+
+		while(view_shift < MAX_SHIFT){
+
+			hd44780_shift_display(HD44780_SHIFT_LEFT);
+			view_shift++;
+		}
+
+		break;
+	}
+
+	update_view();
+}
+
+
+void console_marquee(void){
+
+	if(view_shift < MAX_SHIFT){
+
+		console_scroll(LCD_SHIFT_RIGHT);
+	}
+
+	else{
+
+		console_scroll(LCD_SHIFT_START);
+	}
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* Suppose que le LCD vient d'être effacé */
+static void reset(void){
+
+	uint8_t row;
+
+	first_line = 0;
+	line_count = 1;
+	write_col = 0;
+
+	view_top = 0;
+	view_shift = 0;
+
+	fill(lines[0], BLANK_CHAR);
+
+	for(row = 0; row < LCD_NB_ROW; row++){
+
+		fill(screen[row], BLANK_CHAR);
+	}
+}
+
+
+/* Une ligne du journal, 0 étant la plus ancienne */
+static char* get_line(uint8_t line){
+
+	return lines[(first_line + line) % CONSOLE_NB_LINES];
+}
+
+
+/* Le view_top qui montre les dernières lignes */
+static uint8_t bottom_top(void){
+
+	if(line_count > LCD_NB_ROW){
+
+		return line_count - LCD_NB_ROW;
+	}
+
+	return 0;
+}
+
+
+static void append(char character){
+
+	switch(character){
+	case '\n':
+		new_line();
+		break;
+
+	case '\r':
+		write_col = 0;
+		break;
+
+	default:
+		if(write_col < CONSOLE_LINE_SIZE){
+
+			get_line(line_count - 1)[write_col] = character;
+			write_col++;
+		}
+		break;
+	}
+}
+
+
+static void new_line(void){
+
+	bool follow;
+
+	follow = (view_top == bottom_top());
+
+	if(line_count < CONSOLE_NB_LINES){
+
+		line_count++;
+	}
+
+	else{
+
+		// La plus ancienne ligne est écrasée. Si la fenêtre ne suit pas, elle
+		// reste sur les mêmes lignes.
+		first_line = (first_line + 1) % CONSOLE_NB_LINES;
+
+		if((follow == FALSE) && (view_top > 0)){
+
+			view_top--;
+		}
+	}
+
+	fill(get_line(line_count - 1), BLANK_CHAR);
+	write_col = 0;
+
+	if(follow == TRUE){
+
+		view_top = bottom_top();
+	}
+}
+
+
+static void update_view(void){
+
+	uint8_t row;
+
+	for(row = 0; row < LCD_NB_ROW; row++){
+
+		update_row(row);
+	}
+}
+
+
+/* Réécrit seulement l'intervalle de la rangée qui a changé. Le HD44780 avance
+son adresse tout seul, une seule commande de positionnement suffit. */
+static void update_row(uint8_t row){
+
+	const char* line;
+	uint8_t first;
+	uint8_t last;
+	uint8_t i;
+
+	// Plus de rangées que de lignes dans le journal, la rangée doit être vide
+	if(view_top + row >= line_count){
+
+		line = NULL;
+	}
+
+	else{
+
+		line = get_line(view_top + row);
+	}
+
+	first = CONSOLE_LINE_SIZE;
+	last = 0;
+
+	for(i = 0; i < CONSOLE_LINE_SIZE; i++){
+
+		if(screen[row][i] != ((line != NULL) ? line[i] : BLANK_CHAR)){
+
+			if(first == CONSOLE_LINE_SIZE){
+
+				first = i;
+			}
+
+			last = i;
+		}
+	}
+
+	if(first == CONSOLE_LINE_SIZE){
+
+		return;
+	}
+
+	hd44780_set_cursor_position(first, row);
+
+	for(i = first; i <= last; i++){
+
+		screen[row][i] = (line != NULL) ? line[i] : BLANK_CHAR;
+
+		hd44780_write_char(screen[row][i]);
+	}
+}
+
+
+static void fill(char* line, char character){
+
+	uint8_t i;
+
+	for(i = 0; i < CONSOLE_LINE_SIZE; i++){
+
+		line[i] = character;
+	}
+}
@@ -0,0 +1,142 @@
+#ifndef CONSOLE_H_INCLUDED
+#define CONSOLE_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file console.h
+	\brief Console de type journal sur le LCD, plus grande que l'écran
+	\author Iouri Savard Colbert
+
+	La console garde les CONSOLE_NB_LINES dernières lignes écrites dans un anneau
+	en RAM. Le LCD n'en montre qu'une fenêtre de LCD_NB_ROW lignes, qu'on peut
+	déplacer vers le haut et le bas avec console_scroll(). Quand la fenêtre est au
+	bas du journal, elle suit les nouvelles lignes.
+
+	Les lignes peuvent faire jusqu'à HD44780_LINE_SIZE caractères, soit toute la
+	DDRAM d'une rangée. Le défilement horizontal utilise le décalage de
+	l'affichage du HD44780 : une seule commande déplace toute la fenêtre, sans
+	rien réécrire. console_marquee() s'en sert pour faire défiler les lignes trop
+	longues en boucle.
+
+	Une copie de ce qui est en DDRAM est gardée. Lors d'un défilement vertical ou
+	d'une écriture, seuls les caractères qui diffèrent de ce qui est déjà affiché
+	sont réécrits, en un seul envoi par rangée.
+
+	\code
+
+	console_init();
+
+	char text[4];
+
+	console_write_string("Demarrage\n");
+
+	uint8_to_string(text, adc_read(0));
+	console_write_string("ADC: ");
+	console_write_string(text);
+
+	\endcode
+
+	La console utilise directement le sous-module hd44780. Comme pour le
+	sous-module text, elle ne doit pas être mélangée avec les fonctions lcd_*.
+	Le décalage de l'affichage n'a de sens que sur un LCD d'une ou deux rangées.
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include "utils.h"
+#include "lcd.h"
+
+
+/* ----------------------------------------------------------------------------
+Defines et typedef
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Nombre de lignes gardées en mémoire. Doit être plus grand que LCD_NB_ROW.
+*/
+#define CONSOLE_NB_LINES 8
+
+/**
+    \brief Longueur maximale d'une ligne, au plus HD44780_LINE_SIZE. Les caractères
+	en trop sont ignorés.
+
+	La console utilise CONSOLE_NB_LINES + LCD_NB_ROW fois cette longueur en RAM.
+*/
+#define CONSOLE_LINE_SIZE HD44780_LINE_SIZE
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Fait l'initialisation du LCD et vide la console
+
+	Remplace lcd_init(). Le curseur n'est pas affiché.
+*/
+void console_init(void);
+
+/**
+    \brief Vide la console et l'écran
+*/
+void console_clear(void);
+
+/**
+    \brief Ajoute un caractère à la dernière ligne
+    \param[in]  character   Le caractère. '\\n' commence une nouvelle ligne et
+	'\\r' retourne au début de la dernière ligne.
+
+	Si la ligne la plus ancienne n'a plus de place dans l'anneau, elle est perdue.
+*/
+void console_write_char(char character);
+
+/**
+    \brief Ajoute une string à la console
+    \param[in]  string  La string
+
+	L'écran n'est mis à jour qu'une fois, à la fin de la string.
+*/
+void console_write_string(const char* string);
+
+/**
+    \brief Déplace la fenêtre sur le journal
+    \param[in]  shift   La direction
+
+	LCD_SHIFT_UP et LCD_SHIFT_DOWN déplacent la fenêtre d'une ligne,
+	LCD_SHIFT_TOP et LCD_SHIFT_BOTTOM vont à la plus ancienne et à la plus
+	récente ligne. LCD_SHIFT_RIGHT et LCD_SHIFT_LEFT montrent une colonne de plus
+	à droite ou à gauche, LCD_SHIFT_START et LCD_SHIFT_END vont au début et à la
+	fin des lignes.
+*/
+void console_scroll(lcd_shift_e shift);
+
+/**
+    \brief Avance la fenêtre d'une colonne vers la droite, et revient au début
+	une fois la fin des lignes atteinte
+
+	À appeler à intervalle régulier pour faire défiler les lignes trop longues
+	pour l'écran.
+*/
+void console_marquee(void);
+
+
+#endif // CONSOLE_H_INCLUDED
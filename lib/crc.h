@@ -0,0 +1,246 @@
+#ifndef CRC_H_INCLUDED
+#define CRC_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file crc.h
+	\brief CRC-8, CRC-16 (Modbus et CCITT) et CRC-32
+	\author Iouri Savard Colbert
+
+	Chaque CRC se calcule un byte à la fois, au fur et à mesure que les données
+	arrivent : on part de la valeur _INIT, on appelle _update() pour chaque byte et,
+	pour le CRC-32 seulement, on termine avec CRC32_FINAL().
+
+	\code
+
+	uint16_t crc = CRC16_MODBUS_INIT;
+
+	while(uart_is_rx_buffer_empty() == FALSE){
+
+		crc = crc16_modbus_update(crc, uart_get_byte());
+	}
+
+	\endcode
+
+	Chaque CRC existe en trois méthodes, qui donnent exactement le même résultat :
+
+	- bitwise : une boucle sur les 8 bits. Aucune table, mais la plus lente.
+	- nibble : deux accès à une table de 16 valeurs en flash.
+	- table : un seul accès à une table de 256 valeurs en flash. La plus rapide.
+
+	| CRC             | Table nibble | Table complète |
+	|-----------------|--------------|----------------|
+	| CRC-8           | 16 bytes     | 256 bytes      |
+	| CRC-16 (chacun) | 32 bytes     | 512 bytes      |
+	| CRC-32          | 64 bytes     | 1024 bytes     |
+
+	CRC_METHOD choisit celle qu'utilisent les fonctions sans suffixe, comme
+	crc16_modbus_update(). Les autres ne sont compilées que si
+	CRC_ENABLE_ALL_METHODS est définie. Le programme Bench/bench_crc.c mesure le
+	nombre de cycles par byte de chacune.
+
+	Les valeurs de vérification (le CRC de la string "123456789") sont celles du
+	catalogue habituel des CRC : 0xF4, 0x4B37, 0x29B1 et 0xCBF43926.
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include "utils.h"
+
+
+/* ----------------------------------------------------------------------------
+Switches
+---------------------------------------------------------------------------- */
+
+#define CRC_METHOD_BITWISE  0
+#define CRC_METHOD_NIBBLE   1
+#define CRC_METHOD_TABLE    2
+
+/**
+    \brief La méthode utilisée par les fonctions sans suffixe
+
+	CRC_METHOD_NIBBLE est un bon compromis : environ deux fois plus lente que la
+	table complète, pour une fraction de la flash.
+*/
+#define CRC_METHOD CRC_METHOD_NIBBLE
+
+/**
+    \brief Switch qui compile les trois méthodes de chaque CRC
+
+	Sans elle, seule la méthode CRC_METHOD est compilée, ce qui évite de garder les
+	grandes tables en flash pour rien.
+*/
+//#define CRC_ENABLE_ALL_METHODS
+
+
+/* ----------------------------------------------------------------------------
+Defines
+---------------------------------------------------------------------------- */
+
+/**
+    \brief CRC-8 (polynôme 0x07, non réfléchi, aussi appelé CRC-8/SMBUS)
+*/
+#define CRC8_INIT           0x00
+
+/**
+    \brief CRC-16 de Modbus RTU (polynôme 0x8005 réfléchi)
+
+	Le CRC est transmis le byte le moins significatif en premier. Un CRC calculé sur
+	une trame au complet, incluant son CRC, donne 0.
+*/
+#define CRC16_MODBUS_INIT   0xFFFF
+
+/**
+    \brief CRC-16 CCITT (polynôme 0x1021, non réfléchi, aussi appelé CRC-16/CCITT-FALSE)
+
+	Avec une valeur initiale de 0 plutôt que CRC16_CCITT_INIT, c'est le CRC de
+	XMODEM.
+*/
+#define CRC16_CCITT_INIT    0xFFFF
+
+/**
+    \brief CRC-32 d'Ethernet, de zip et de PNG (polynôme 0x04C11DB7 réfléchi)
+*/
+#define CRC32_INIT          0xFFFFFFFFUL
+
+/**
+    \brief Dernière étape du CRC-32, une fois tous les bytes traités
+*/
+#define CRC32_FINAL(crc)    ((crc) ^ 0xFFFFFFFFUL)
+
+#if defined(CRC_ENABLE_ALL_METHODS) || (CRC_METHOD == CRC_METHOD_BITWISE)
+#define CRC_ENABLE_BITWISE
+#endif
+
+#if defined(CRC_ENABLE_ALL_METHODS) || (CRC_METHOD == CRC_METHOD_NIBBLE)
+#define CRC_ENABLE_NIBBLE
+#endif
+
+#if defined(CRC_ENABLE_ALL_METHODS) || (CRC_METHOD == CRC_METHOD_TABLE)
+#define CRC_ENABLE_TABLE
+#endif
+
+#if CRC_METHOD == CRC_METHOD_BITWISE
+
+#define crc8_update(crc, byte)          crc8_update_bitwise((crc), (byte))
+#define crc16_modbus_update(crc, byte)  crc16_modbus_update_bitwise((crc), (byte))
+#define crc16_ccitt_update(crc, byte)   crc16_ccitt_update_bitwise((crc), (byte))
+#define crc32_update(crc, byte)         crc32_update_bitwise((crc), (byte))
+
+#elif CRC_METHOD == CRC_METHOD_NIBBLE
+
+#define crc8_update(crc, byte)          crc8_update_nibble((crc), (byte))
+#define crc16_modbus_update(crc, byte)  crc16_modbus_update_nibble((crc), (byte))
+#define crc16_ccitt_update(crc, byte)   crc16_ccitt_update_nibble((crc), (byte))
+#define crc32_update(crc, byte)         crc32_update_nibble((crc), (byte))
+
+#elif CRC_METHOD == CRC_METHOD_TABLE
+
+#define crc8_update(crc, byte)          crc8_update_table((crc), (byte))
+#define crc16_modbus_update(crc, byte)  crc16_modbus_update_table((crc), (byte))
+#define crc16_ccitt_update(crc, byte)   crc16_ccitt_update_table((crc), (byte))
+#define crc32_update(crc, byte)         crc32_update_table((crc), (byte))
+
+#else
+#error "CRC_METHOD doit être CRC_METHOD_BITWISE, CRC_METHOD_NIBBLE ou CRC_METHOD_TABLE"
+#endif
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Ajoute un bloc de bytes à un CRC-8
+    \param[in]  crc     Le CRC jusqu'ici, ou CRC8_INIT
+    \param[in]  data    Les bytes à ajouter
+    \param[in]  length  Le nombre de bytes
+    \return Le nouveau CRC
+
+	Utilise la méthode CRC_METHOD. Il en va de même pour les trois fonctions
+	suivantes.
+*/
+uint8_t crc8_update_block(uint8_t crc, const void* data, uint16_t length);
+
+/**
+    \brief Ajoute un bloc de bytes à un CRC-16 de Modbus
+*/
+uint16_t crc16_modbus_update_block(uint16_t crc, const void* data, uint16_t length);
+
+/**
+    \brief Ajoute un bloc de bytes à un CRC-16 CCITT
+*/
+uint16_t crc16_ccitt_update_block(uint16_t crc, const void* data, uint16_t length);
+
+/**
+    \brief Ajoute un bloc de bytes à un CRC-32. CRC32_FINAL() n'est pas appliqué.
+*/
+uint32_t crc32_update_block(uint32_t crc, const void* data, uint16_t length);
+
+
+#ifdef CRC_ENABLE_BITWISE
+
+/**
+    \brief Ajoute un byte à un CRC, méthode bitwise
+    \param[in]  crc     Le CRC jusqu'ici, ou la valeur _INIT
+    \param[in]  byte    Le byte à ajouter
+    \return Le nouveau CRC
+*/
+uint8_t crc8_update_bitwise(uint8_t crc, uint8_t byte);
+uint16_t crc16_modbus_update_bitwise(uint16_t crc, uint8_t byte);
+uint16_t crc16_ccitt_update_bitwise(uint16_t crc, uint8_t byte);
+uint32_t crc32_update_bitwise(uint32_t crc, uint8_t byte);
+
+#endif
+
+#ifdef CRC_ENABLE_NIBBLE
+
+/**
+    \brief Ajoute un byte à un CRC, méthode nibble
+    \param[in]  crc     Le CRC jusqu'ici, ou la valeur _INIT
+    \param[in]  byte    Le byte à ajouter
+    \return Le nouveau CRC
+*/
+uint8_t crc8_update_nibble(uint8_t crc, uint8_t byte);
+uint16_t crc16_modbus_update_nibble(uint16_t crc, uint8_t byte);
+uint16_t crc16_ccitt_update_nibble(uint16_t crc, uint8_t byte);
+uint32_t crc32_update_nibble(uint32_t crc, uint8_t byte);
+
+#endif
+
+#ifdef CRC_ENABLE_TABLE
+
+/**
+    \brief Ajoute un byte à un CRC, méthode table complète
+    \param[in]  crc     Le CRC jusqu'ici, ou la valeur _INIT
+    \param[in]  byte    Le byte à ajouter
+    \return Le nouveau CRC
+*/
+uint8_t crc8_update_table(uint8_t crc, uint8_t byte);
+uint16_t crc16_modbus_update_table(uint16_t crc, uint8_t byte);
+uint16_t crc16_ccitt_update_table(uint16_t crc, uint8_t byte);
+uint32_t crc32_update_table(uint32_t crc, uint8_t byte);
+
+#endif
+
+
+#endif // CRC_H_INCLUDED
@@ -120,3 +120,33 @@ bool fifo_is_full(fifo_t* fifo){
 
     return fifo->is_full;
 }
+
+
+uint8_t fifo_get_count(fifo_t* fifo){
+
+    uint8_t count;
+
+    if(fifo->is_full == TRUE){
+
+        count = fifo->size;
+    }
+
+    else if(fifo->in_offset >= fifo->out_offset){
+
+        count = fifo->in_offset - fifo->out_offset;
+    }
+
+    /* L'index d'entrée a déjà fait le tour du buffer */
+    else{
+
+        count = fifo->size - fifo->out_offset + fifo->in_offset;
+    }
+
+    return count;
+}
+
+
+uint8_t fifo_get_free_space(fifo_t* fifo){
+
+    return fifo->size - fifo_get_count(fifo);
+}
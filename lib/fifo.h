@@ -48,5 +48,7 @@ uint8_t fifo_pop(fifo_t* fifo);
 void fifo_clean(fifo_t* fifo);
 bool fifo_is_empty(fifo_t* fifo);
 bool fifo_is_full(fifo_t* fifo);
+uint8_t fifo_get_count(fifo_t* fifo);
+uint8_t fifo_get_free_space(fifo_t* fifo);
 
 #endif // FIFO_H_INCLUDED
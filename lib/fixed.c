@@ -0,0 +1,301 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file fixed.c
+	\brief Nombres à virgule fixe Q8.8 et Q16.16
+	\author Iouri Savard Colbert
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include "fixed.h"
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+static const uint16_t power_of_ten[FIXED_MAX_DECIMALS + 1] = {1, 10, 100, 1000, 10000};
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static q16_16_t saturate(uint32_t magnitude, bool negative, bool overflow);
+
+
+/******************************************************************************
+Global functions
+******************************************************************************/
+
+/* Q8.8 */
+
+q8_8_t q8_8_add(q8_8_t a, q8_8_t b){
+
+	uint16_t sum = (uint16_t)a + (uint16_t)b;
+
+	/* Il y a débordement seulement si a et b ont le même signe et que la somme a
+	l'autre signe */
+	if((((uint16_t)a ^ sum) & ((uint16_t)b ^ sum) & 0x8000) != 0){
+
+		return (a < 0) ? Q8_8_MIN : Q8_8_MAX;
+	}
+
+	return (q8_8_t)sum;
+}
+
+
+q8_8_t q8_8_sub(q8_8_t a, q8_8_t b){
+
+	uint16_t difference = (uint16_t)a - (uint16_t)b;
+
+	/* Débordement si a et b ont des signes différents et que la différence n'a pas
+	celui de a */
+	if((((uint16_t)a ^ (uint16_t)b) & ((uint16_t)a ^ difference) & 0x8000) != 0){
+
+		return (a < 0) ? Q8_8_MIN : Q8_8_MAX;
+	}
+
+	return (q8_8_t)difference;
+}
+
+
+q8_8_t q8_8_mul(q8_8_t a, q8_8_t b){
+
+	int32_t product;
+
+	/* Le + 0x80 arrondi au plus près, les demis vers le haut */
+	product = ((int32_t)a * b + 0x80) >> 8;
+
+	if(product > Q8_8_MAX){
+
+		return Q8_8_MAX;
+	}
+
+	if(product < Q8_8_MIN){
+
+		return Q8_8_MIN;
+	}
+
+	return (q8_8_t)product;
+}
+
+
+q8_8_t q8_8_from_adc(uint16_t counts, uint8_t resolution, q8_8_t reference){
+
+	uint32_t product;
+
+	/* Au plus 16 bits par 15 bits, le produit tient sur 32 bits */
+	product = (uint32_t)counts * (uint16_t)reference;
+
+	return (q8_8_t)((product + ((uint32_t)1 << (resolution - 1))) >> resolution);
+}
+
+
+uint8_t q8_8_to_string(char* out_string, q8_8_t value, uint8_t decimals){
+
+	return q16_16_to_string(out_string, q16_16_from_q8_8(value), decimals);
+}
+
+
+/* Q16.16 */
+
+q16_16_t q16_16_add(q16_16_t a, q16_16_t b){
+
+	uint32_t sum = (uint32_t)a + (uint32_t)b;
+
+	if((((uint32_t)a ^ sum) & ((uint32_t)b ^ sum) & 0x80000000UL) != 0){
+
+		return (a < 0) ? Q16_16_MIN : Q16_16_MAX;
+	}
+
+	return (q16_16_t)sum;
+}
+
+
+q16_16_t q16_16_sub(q16_16_t a, q16_16_t b){
+
+	uint32_t difference = (uint32_t)a - (uint32_t)b;
+
+	if((((uint32_t)a ^ (uint32_t)b) & ((uint32_t)a ^ difference) & 0x80000000UL) != 0){
+
+		return (a < 0) ? Q16_16_MIN : Q16_16_MAX;
+	}
+
+	return (q16_16_t)difference;
+}
+
+
+q16_16_t q16_16_mul(q16_16_t a, q16_16_t b){
+
+	uint32_t magnitude_a;
+	uint32_t magnitude_b;
+	uint16_t a_high;
+	uint16_t a_low;
+	uint16_t b_high;
+	uint16_t b_low;
+	uint32_t high;
+	uint32_t part;
+	uint32_t result;
+	bool negative;
+
+	negative = ((a < 0) != (b < 0));
+
+	magnitude_a = (a < 0) ? -(uint32_t)a : (uint32_t)a;
+	magnitude_b = (b < 0) ? -(uint32_t)b : (uint32_t)b;
+
+	a_high = (uint16_t)(magnitude_a >> 16);
+	a_low = (uint16_t)magnitude_a;
+	b_high = (uint16_t)(magnitude_b >> 16);
+	b_low = (uint16_t)magnitude_b;
+
+	/* Le produit complet est high * 2^32 + (a_high * b_low + a_low * b_high) * 2^16
+	+ a_low * b_low. Le résultat, en Q16.16, est ce produit divisé par 2^16. */
+	high = (uint32_t)a_high * b_high;
+
+	/* high * 2^16 ne tient même pas dans la magnitude de INT32_MIN */
+	if(high > 0x8000){
+
+		return saturate(0, negative, TRUE);
+	}
+
+	result = high << 16;
+
+	part = (uint32_t)a_high * b_low;
+	result += part;
+
+	if(result < part){
+
+		return saturate(0, negative, TRUE);
+	}
+
+	part = (uint32_t)a_low * b_high;
+	result += part;
+
+	if(result < part){
+
+		return saturate(0, negative, TRUE);
+	}
+
+	/* Au plus 0xFFFE0001 + 0x8000, pas de débordement avant le décalage */
+	part = ((uint32_t)a_low * b_low + 0x8000) >> 16;
+	result += part;
+
+	if(result < part){
+
+		return saturate(0, negative, TRUE);
+	}
+
+	return saturate(result, negative, FALSE);
+}
+
+
+q16_16_t q16_16_from_adc(uint16_t counts, uint8_t resolution, q16_16_t reference){
+
+	uint32_t mask;
+	uint32_t result;
+
+	mask = ((uint32_t)1 << resolution) - 1;
+
+	/* reference * counts ne tient pas toujours sur 32 bits. On sépare reference en
+	sa partie divisible par 2^resolution, qui donne un résultat exact, et le reste,
+	qui fait au plus resolution bits et dont le produit avec counts tient donc sur
+	32 bits. */
+	result = ((uint32_t)reference >> resolution) * counts;
+	result += ((((uint32_t)reference & mask) * counts) + (mask >> 1) + 1) >> resolution;
+
+	return (q16_16_t)result;
+}
+
+
+uint8_t q16_16_to_string(char* out_string, q16_16_t value, uint8_t decimals){
+
+	uint32_t magnitude;
+	uint32_t integer;
+	uint32_t fraction;
+	uint8_t length = 0;
+
+	if(decimals > FIXED_MAX_DECIMALS){
+
+		decimals = FIXED_MAX_DECIMALS;
+	}
+
+	magnitude = (value < 0) ? -(uint32_t)value : (uint32_t)value;
+
+	integer = magnitude >> 16;
+
+	/* Les décimales arrondies au plus près, comme un entier. Au plus 0xFFFF * 10000,
+	ça tient sur 32 bits. */
+	fraction = (((magnitude & 0xFFFF) * power_of_ten[decimals]) + 0x8000) >> 16;
+
+	/* Par exemple 0.9999 avec 2 décimales donne 1.00 */
+	if(fraction >= power_of_ten[decimals]){
+
+		integer++;
+		fraction = 0;
+	}
+
+	/* Pas de "-0.00" pour un petit nombre négatif */
+	if((value < 0) && ((integer != 0) || (fraction != 0))){
+
+		out_string[length] = '-';
+		length++;
+	}
+
+	length += uint32_to_string_unpadded(&out_string[length], integer);
+
+	if(decimals > 0){
+
+		out_string[length] = '.';
+		length++;
+
+		length += uint32_to_string_aligned(&out_string[length], fraction, decimals, '0');
+	}
+
+	return length;
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* Applique le signe à une magnitude, en saturant à Q16_16_MIN ou Q16_16_MAX */
+static q16_16_t saturate(uint32_t magnitude, bool negative, bool overflow){
+
+	if(negative == TRUE){
+
+		if((overflow == TRUE) || (magnitude > 0x80000000UL)){
+
+			return Q16_16_MIN;
+		}
+
+		return (q16_16_t)(0 - magnitude);
+	}
+
+	if((overflow == TRUE) || (magnitude > 0x7FFFFFFFUL)){
+
+		return Q16_16_MAX;
+	}
+
+	return (q16_16_t)magnitude;
+}
@@ -0,0 +1,259 @@
+#ifndef FIXED_H_INCLUDED
+#define FIXED_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file fixed.h
+	\brief Nombres à virgule fixe Q8.8 et Q16.16
+	\author Iouri Savard Colbert
+
+	Le microcontrôleur n'a pas d'unité de calcul à virgule flottante. Chaque
+	opération sur un float appelle une routine de plusieurs centaines de cycles et
+	la librairie ajoute quelques kilo-octets au programme. Un nombre à virgule fixe
+	est simplement un entier dont les derniers bits sont la partie fractionnaire :
+
+	- q8_8_t : 16 bits signés, 8 bits de fraction. De -128 à 127.996, par pas de
+	1/256 (environ 0.004).
+	- q16_16_t : 32 bits signés, 16 bits de fraction. De -32768 à 32767.99998, par
+	pas de 1/65536 (environ 0.000015).
+
+	Les additions et les soustractions se font comme avec des entiers. Les fonctions
+	de ce module ajoutent la saturation : un résultat trop grand devient la plus
+	grande valeur possible au lieu de changer de signe.
+
+	\code
+
+	#define VREF Q16_16(5.0)
+
+	q16_16_t volts;
+	q16_16_t average = 0;
+	char text[FIXED_STRING_SIZE];
+
+	volts = q16_16_from_adc(adc_read(), 10, VREF);
+
+	// Filtre passe-bas : average += (volts - average) / 8
+	average = q16_16_add(average, (volts - average) / 8);
+
+	q16_16_to_string(text, average, 2);    // "3.27"
+
+	\endcode
+
+	Les macros Q8_8() et Q16_16() acceptent un littéral à virgule, mais elles ne
+	doivent servir qu'avec des constantes : le compilateur fait alors le calcul au
+	complet et aucun float ne se retrouve dans le programme.
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include "utils.h"
+
+
+/* ----------------------------------------------------------------------------
+Defines et typedef
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Nombre signé avec 8 bits de fraction
+*/
+typedef int16_t q8_8_t;
+
+/**
+    \brief Nombre signé avec 16 bits de fraction
+*/
+typedef int32_t q16_16_t;
+
+#define Q8_8_ONE        256
+#define Q8_8_MAX        INT16_MAX
+#define Q8_8_MIN        INT16_MIN
+
+#define Q16_16_ONE      65536L
+#define Q16_16_MAX      INT32_MAX
+#define Q16_16_MIN      INT32_MIN
+
+/**
+    \brief Nombre maximal de décimales affichées par q8_8_to_string() et
+	q16_16_to_string()
+*/
+#define FIXED_MAX_DECIMALS 4
+
+/**
+    \brief Longueur minimale d'une string passée à q8_8_to_string() ou
+	q16_16_to_string() : "-32768.0000" et le '\\0'
+*/
+#define FIXED_STRING_SIZE 12
+
+/**
+    \brief Converti une constante en Q8.8, arrondie au plus près
+    \warning Seulement pour des constantes, sinon le calcul se fait en float
+*/
+#define Q8_8(value)     ((q8_8_t)(((value) * 256.0) + (((value) >= 0) ? 0.5 : -0.5)))
+
+/**
+    \brief Converti une constante en Q16.16, arrondie au plus près
+    \warning Seulement pour des constantes, sinon le calcul se fait en float
+*/
+#define Q16_16(value)   ((q16_16_t)(((value) * 65536.0) + (((value) >= 0) ? 0.5 : -0.5)))
+
+/**
+    \brief Converti un entier en Q8.8. L'entier doit être entre -128 et 127.
+*/
+#define q8_8_from_int(integer)      ((q8_8_t)((integer) * Q8_8_ONE))
+
+/**
+    \brief Converti un entier en Q16.16. L'entier doit être entre -32768 et 32767.
+*/
+#define q16_16_from_int(integer)    ((q16_16_t)((integer) * Q16_16_ONE))
+
+/**
+    \brief Partie entière, arrondie vers le bas (-1.5 donne -2)
+*/
+#define q8_8_to_int(value)          ((int8_t)((value) >> 8))
+#define q16_16_to_int(value)        ((int16_t)((value) >> 16))
+
+/**
+    \brief Converti un Q8.8 en Q16.16, sans perte
+*/
+#define q16_16_from_q8_8(value)     ((q16_16_t)(value) * 256)
+
+/**
+    \brief Division entière arrondie au plus près, pour des valeurs non signées
+    \param[in]  numerator   Le nombre à diviser
+    \param[in]  divisor     Une constante
+
+	Avec une constante, le d/2 est calculé par le compilateur. Pour éviter
+	complètement la division, on peut plutôt multiplier par l'inverse :
+
+	\code
+	third = q16_16_mul(value, Q16_16(1.0 / 3.0));
+	\endcode
+*/
+#define FIXED_DIV_ROUND(numerator, divisor) \
+	(((numerator) + ((divisor) / 2)) / (divisor))
+
+/**
+    \brief Division entière arrondie au plus près (les demis s'éloignent de zéro),
+	pour des valeurs signées
+    \param[in]  numerator   Le nombre à diviser
+    \param[in]  divisor     Une constante positive
+*/
+#define FIXED_DIV_ROUND_SIGNED(numerator, divisor) \
+	(((numerator) < 0) ? (((numerator) - ((divisor) / 2)) / (divisor)) : (((numerator) + ((divisor) / 2)) / (divisor)))
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/* Q8.8 *********************************************************************/
+
+/**
+    \brief Addition saturée à Q8_8_MIN et Q8_8_MAX
+*/
+q8_8_t q8_8_add(q8_8_t a, q8_8_t b);
+
+/**
+    \brief Soustraction (a - b) saturée à Q8_8_MIN et Q8_8_MAX
+*/
+q8_8_t q8_8_sub(q8_8_t a, q8_8_t b);
+
+/**
+    \brief Multiplication arrondie au plus près et saturée à Q8_8_MIN et Q8_8_MAX
+
+	Se fait avec une seule multiplication de 16 bits par 16 bits.
+*/
+q8_8_t q8_8_mul(q8_8_t a, q8_8_t b);
+
+/**
+    \brief Converti une lecture de l'ADC en Q8.8
+    \param[in]  counts      La lecture de l'ADC
+    \param[in]  resolution  Le nombre de bits de l'ADC, de 1 à 16 (10 pour l'ATmega32,
+	8 si seul ADCH est lu)
+    \param[in]  reference   La valeur qui correspond à 2^resolution, par exemple la
+	tension de référence en volts. Doit être positive.
+    \return counts * reference / 2^resolution, arrondi au plus près
+*/
+q8_8_t q8_8_from_adc(uint16_t counts, uint8_t resolution, q8_8_t reference);
+
+/**
+    \brief Converti un Q8.8 en string, avec un nombre fixe de décimales
+    \param[out] out_string  La string de destination, au moins FIXED_STRING_SIZE caractères
+    \param[in]  value       Le nombre à convertir
+    \param[in]  decimals    Le nombre de chiffres après le point, de 0 à
+	FIXED_MAX_DECIMALS. Avec 0, il n'y a pas de point.
+    \return Le nombre de caractères ajoutés à la string sans compter le '\\0'
+
+	La valeur est arrondie au plus près. Comme pour int32_to_string_unpadded(), il
+	n'y a ni '+' ni zéros de gauche : -1.5 avec 2 décimales donne "-1.50".
+*/
+uint8_t q8_8_to_string(char* out_string, q8_8_t value, uint8_t decimals);
+
+
+/* Q16.16 *******************************************************************/
+
+/**
+    \brief Addition saturée à Q16_16_MIN et Q16_16_MAX
+*/
+q16_16_t q16_16_add(q16_16_t a, q16_16_t b);
+
+/**
+    \brief Soustraction (a - b) saturée à Q16_16_MIN et Q16_16_MAX
+*/
+q16_16_t q16_16_sub(q16_16_t a, q16_16_t b);
+
+/**
+    \brief Multiplication arrondie au plus près et saturée à Q16_16_MIN et Q16_16_MAX
+
+	Le produit complet ferait 64 bits. Il est plutôt construit à partir de quatre
+	multiplications de 16 bits par 16 bits, ce qui évite la très lente
+	multiplication 64 bits de avr-gcc.
+*/
+q16_16_t q16_16_mul(q16_16_t a, q16_16_t b);
+
+/**
+    \brief Converti une lecture de l'ADC en Q16.16
+    \param[in]  counts      La lecture de l'ADC
+    \param[in]  resolution  Le nombre de bits de l'ADC, de 1 à 16
+    \param[in]  reference   La valeur qui correspond à 2^resolution. Doit être
+	positive.
+    \return counts * reference / 2^resolution, arrondi au plus près
+
+	\code
+	// Un capteur de température de 10 mV par degré
+	celsius = q16_16_from_adc(counts, 10, Q16_16(5.0 / 0.010));
+	\endcode
+*/
+q16_16_t q16_16_from_adc(uint16_t counts, uint8_t resolution, q16_16_t reference);
+
+/**
+    \brief Converti un Q16.16 en string, avec un nombre fixe de décimales
+    \param[out] out_string  La string de destination, au moins FIXED_STRING_SIZE caractères
+    \param[in]  value       Le nombre à convertir
+    \param[in]  decimals    Le nombre de chiffres après le point, de 0 à
+	FIXED_MAX_DECIMALS. Avec 0, il n'y a pas de point.
+    \return Le nombre de caractères ajoutés à la string sans compter le '\\0'
+
+	\sa q8_8_to_string()
+*/
+uint8_t q16_16_to_string(char* out_string, q16_16_t value, uint8_t decimals);
+
+
+#endif // FIXED_H_INCLUDED
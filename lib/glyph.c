@@ -0,0 +1,250 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file glyph.c
+	\brief Gestion des caractères personnalisés du LCD
+	\author Iouri Savard Colbert
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <avr/pgmspace.h>
+
+#include "glyph.h"
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+/* Aucune place de CGRAM ne contient le dessin */
+#define NO_SLOT 0xFF
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+static const uint8_t (*bitmap_table)[HD44780_CGRAM_HEIGHT];
+static uint8_t bitmap_count;
+
+/* L'adresse en flash du dessin présent dans chaque place de CGRAM, NULL si la
+place ne contient rien de connu */
+static const uint8_t* slot_bitmap[HD44780_NB_CGRAM_CHAR];
+
+/* L'âge de chaque place : 0 pour la plus récemment demandée, jusqu'à
+HD44780_NB_CGRAM_CHAR - 1 pour la prochaine à être reprise. Les âges sont
+toujours tous différents. */
+static uint8_t slot_age[HD44780_NB_CGRAM_CHAR];
+
+/* Le nombre de glyph_acquire_P() sans leur glyph_release() pour chaque place. Une
+place réservée n'est jamais reprise. */
+static uint8_t slot_users[HD44780_NB_CGRAM_CHAR];
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static uint8_t get_slot(const uint8_t* bitmap);
+static uint8_t find_slot(const uint8_t* bitmap);
+static uint8_t oldest_slot(void);
+static void touch_slot(uint8_t slot);
+static void upload(uint8_t slot, const uint8_t* bitmap);
+
+
+/******************************************************************************
+Global functions
+******************************************************************************/
+
+void glyph_init(const uint8_t (*bitmaps)[HD44780_CGRAM_HEIGHT], uint8_t count){
+
+	bitmap_table = bitmaps;
+	bitmap_count = count;
+
+	glyph_flush();
+}
+
+
+char glyph_get(uint8_t id){
+
+	if(id >= bitmap_count){
+
+		return ' ';
+	}
+
+	return glyph_get_P(bitmap_table[id]);
+}
+
+
+char glyph_get_P(const uint8_t* bitmap){
+
+	uint8_t slot;
+
+	slot = get_slot(bitmap);
+
+	if(slot == NO_SLOT){
+
+		return ' ';
+	}
+
+	return (char)slot;
+}
+
+
+void glyph_flush(void){
+
+	uint8_t i;
+
+	for(i = 0; i < HD44780_NB_CGRAM_CHAR; i++){
+
+		slot_bitmap[i] = NULL;
+		slot_users[i] = 0;
+
+		// La place 0 sera la première utilisée
+		slot_age[i] = HD44780_NB_CGRAM_CHAR - 1 - i;
+	}
+}
+
+
+uint8_t glyph_acquire_P(const uint8_t* bitmap){
+
+	uint8_t slot;
+
+	slot = get_slot(bitmap);
+
+	if(slot == NO_SLOT){
+
+		return GLYPH_NONE;
+	}
+
+	slot_users[slot]++;
+
+	return slot;
+}
+
+
+void glyph_release(uint8_t code){
+
+	// Une place déjà rendue (après un glyph_flush(), par exemple) reste à 0
+	if((code < HD44780_NB_CGRAM_CHAR) && (slot_users[code] > 0)){
+
+		slot_users[code]--;
+	}
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* La place du dessin, après l'avoir envoyé en CGRAM au besoin. NO_SLOT si le
+dessin n'y est pas et que toutes les places sont réservées. */
+static uint8_t get_slot(const uint8_t* bitmap){
+
+	uint8_t slot;
+
+	slot = find_slot(bitmap);
+
+	if(slot == NO_SLOT){
+
+		slot = oldest_slot();
+
+		if(slot == NO_SLOT){
+
+			return NO_SLOT;
+		}
+
+		upload(slot, bitmap);
+	}
+
+	touch_slot(slot);
+
+	return slot;
+}
+
+
+static uint8_t find_slot(const uint8_t* bitmap){
+
+	uint8_t i;
+
+	for(i = 0; i < HD44780_NB_CGRAM_CHAR; i++){
+
+		if(slot_bitmap[i] == bitmap){
+
+			return i;
+		}
+	}
+
+	return NO_SLOT;
+}
+
+
+/* La plus vieille place qui n'est pas réservée, NO_SLOT s'il n'y en a pas */
+static uint8_t oldest_slot(void){
+
+	uint8_t i;
+	uint8_t oldest = NO_SLOT;
+
+	for(i = 0; i < HD44780_NB_CGRAM_CHAR; i++){
+
+		if((slot_users[i] == 0) && ((oldest == NO_SLOT) || (slot_age[i] > slot_age[oldest]))){
+
+			oldest = i;
+		}
+	}
+
+	return oldest;
+}
+
+
+/* Rend la place la plus récente. Les places plus récentes qu'elle vieillissent
+d'un cran, les autres ne bougent pas. */
+static void touch_slot(uint8_t slot){
+
+	uint8_t i;
+
+	for(i = 0; i < HD44780_NB_CGRAM_CHAR; i++){
+
+		if(slot_age[i] < slot_age[slot]){
+
+			slot_age[i]++;
+		}
+	}
+
+	slot_age[slot] = 0;
+}
+
+
+static void upload(uint8_t slot, const uint8_t* bitmap){
+
+	uint8_t buffer[HD44780_CGRAM_HEIGHT];
+	uint8_t i;
+
+	for(i = 0; i < HD44780_CGRAM_HEIGHT; i++){
+
+		buffer[i] = pgm_read_byte(&bitmap[i]);
+	}
+
+	hd44780_write_cgram(slot, buffer);
+
+	slot_bitmap[slot] = bitmap;
+}
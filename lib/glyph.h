@@ -0,0 +1,148 @@
+#ifndef GLYPH_H_INCLUDED
+#define GLYPH_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file glyph.h
+	\brief Gestion des caractères personnalisés du LCD
+	\author Iouri Savard Colbert
+
+	Le HD44780 n'a que HD44780_NB_CGRAM_CHAR places en CGRAM pour des caractères
+	personnalisés. Ce module permet d'en utiliser plus : les dessins restent en
+	flash, et le programme demande un dessin par son numéro. glyph_get() retourne
+	le code de caractère à écrire au LCD.
+
+	Si le dessin est déjà en CGRAM, rien n'est envoyé au LCD. Sinon, il remplace
+	celui qui a été demandé il y a le plus longtemps (LRU). Réafficher les mêmes
+	gros chiffres ou les mêmes icônes à chaque boucle ne coûte donc qu'une
+	recherche dans une table de 8 bytes.
+
+	\code
+
+	static const uint8_t bitmaps[][HD44780_CGRAM_HEIGHT] PROGMEM = {
+
+		{0x04, 0x0E, 0x1F, 0x04, 0x04, 0x04, 0x04, 0x00},	// flèche vers le haut
+		{0x04, 0x04, 0x04, 0x04, 0x1F, 0x0E, 0x04, 0x00},	// flèche vers le bas
+	};
+
+	lcd_init();
+	glyph_init(bitmaps, 2);
+
+	lcd_write_char(glyph_get(0));
+
+	\endcode
+
+	Attention : les cases qui affichent un caractère dont la place est reprise
+	changent de dessin immédiatement. Un même écran ne peut donc pas montrer plus
+	de HD44780_NB_CGRAM_CHAR dessins différents à la fois.
+
+	Un dessin qui doit rester à l'écran se demande plutôt avec glyph_acquire_P().
+	Sa place ne peut pas être reprise tant qu'il n'a pas été rendu avec
+	glyph_release().
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include "utils.h"
+#include "lcd.h"
+
+
+/* ----------------------------------------------------------------------------
+Defines
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Retourné par glyph_acquire_P() quand toutes les places sont réservées
+*/
+#define GLYPH_NONE 0xFF
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Fait l'initialisation du module
+    \param[in]  bitmaps Les dessins, en flash (PROGMEM)
+    \param[in]  count   Le nombre de dessins dans la table
+
+	Le LCD doit avoir été initialisé avant. Les caractères déjà en CGRAM sont
+	considérés comme inconnus. Un programme qui n'a pas de table à lui peut
+	appeler glyph_init(NULL, 0).
+*/
+void glyph_init(const uint8_t (*bitmaps)[HD44780_CGRAM_HEIGHT], uint8_t count);
+
+/**
+    \brief Retourne le code de caractère qui affiche un dessin
+    \param[in]  id  Le numéro du dessin dans la table
+	\return Le code à passer à lcd_write_char(), de 0 à HD44780_NB_CGRAM_CHAR - 1
+
+	Le dessin est envoyé en CGRAM seulement s'il n'y est pas déjà. Un numéro
+	invalide retourne un espace, tout comme une demande faite alors que toutes les
+	places sont réservées par glyph_acquire_P().
+
+	Le code 0 est un caractère valide, mais il termine une string. Il faut donc
+	l'écrire avec lcd_write_char() plutôt qu'avec lcd_write_string().
+*/
+char glyph_get(uint8_t id);
+
+/**
+    \brief Retourne le code de caractère qui affiche un dessin hors de la table
+    \param[in]  bitmap  Le dessin, HD44780_CGRAM_HEIGHT bytes en flash (PROGMEM)
+	\return Le code à passer à lcd_write_char()
+
+	Permet aux autres modules (bargraph, par exemple) d'avoir leurs propres
+	dessins tout en partageant la CGRAM avec ceux de la table. Un dessin est
+	reconnu par son adresse en flash.
+*/
+char glyph_get_P(const uint8_t* bitmap);
+
+/**
+    \brief Oublie le contenu de la CGRAM
+
+	À appeler si la CGRAM a été modifiée sans passer par ce module, par exemple
+	avec hd44780_write_cgram(). Les prochains glyph_get() renverront les dessins.
+	Les réservations sont aussi annulées : ce qui est affiché doit être redessiné.
+*/
+void glyph_flush(void);
+
+/**
+    \brief Retourne le code d'un dessin et lui réserve sa place en CGRAM
+    \param[in]  bitmap  Le dessin, HD44780_CGRAM_HEIGHT bytes en flash (PROGMEM)
+	\return Le code à passer à lcd_write_code(), ou GLYPH_NONE si les
+	HD44780_NB_CGRAM_CHAR places sont déjà réservées par d'autres dessins
+
+	Comme glyph_get_P(), mais la place n'est plus reprise par les demandes
+	suivantes. Chaque appel doit être suivi d'un glyph_release() quand le dessin
+	n'est plus affiché. Un même dessin peut être réservé plusieurs fois.
+*/
+uint8_t glyph_acquire_P(const uint8_t* bitmap);
+
+/**
+    \brief Rend une place réservée avec glyph_acquire_P()
+    \param[in]  code    Le code retourné par glyph_acquire_P(). GLYPH_NONE est
+	ignoré.
+*/
+void glyph_release(uint8_t code);
+
+
+#endif // GLYPH_H_INCLUDED
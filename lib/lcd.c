@@ -19,9 +19,16 @@ Includes
 ******************************************************************************/
 
 #include <avr/io.h>
+#include <avr/pgmspace.h>
 #include "lcd.h"
+#include "reg.h"
 #include <util/delay.h>
 
+#ifdef LCD_ENABLE_ASYNC
+#include <avr/interrupt.h>
+#include "fifo.h"
+#endif
+
 
 /******************************************************************************
 Defines
@@ -29,29 +36,220 @@ Defines
 
 #define FUNCTION_SET 0b00111000
 
-#define FALLING_EDGE()  CTRL_PORT = clear_bit(CTRL_PORT, E_PIN)
-#define RISING_EDGE()   CTRL_PORT = set_bit(CTRL_PORT, E_PIN)
-#define COMMAND_MODE()  CTRL_PORT = clear_bit(CTRL_PORT, RS_PIN)
-#define DATA_MODE()     CTRL_PORT = set_bit(CTRL_PORT, RS_PIN)
+#ifdef LCD_ENABLE_MULTIPLE_DISPLAYS
+
+#if defined(LCD_ENABLE_FRAMEBUFFER) || defined(LCD_ENABLE_ASYNC) || defined(LCD_ENABLE_TEXT_MODULE)
+#error "LCD_ENABLE_MULTIPLE_DISPLAYS ne peut pas être combinée avec le framebuffer, le mode asynchrone ou le sous-module text"
+#endif
+
+/* La broche enable du LCD sélectionné */
+#define E_MASK e_mask
+
+#else
+
+#define E_MASK (1 << E_PIN)
+
+#endif
+
+/* Avec un seul LCD, chaque macro devient une seule instruction sbi ou cbi. Avec
+plusieurs, E_MASK est une variable et l'écriture est protégée des interruptions. */
+#define FALLING_EDGE()  reg_clear_bits(CTRL_PORT, E_MASK)
+#define RISING_EDGE()   reg_set_bits(CTRL_PORT, E_MASK)
+#define COMMAND_MODE()  reg_clear_bit(CTRL_PORT, RS_PIN)
+#define DATA_MODE()     reg_set_bit(CTRL_PORT, RS_PIN)
+#define READ_MODE()     reg_set_bit(CTRL_PORT, RW_PIN)
+#define WRITE_MODE()    reg_clear_bit(CTRL_PORT, RW_PIN)
+
+#define BUSY_FLAG 7
+
+/* Nombre maximal de lectures du busy flag (une par microseconde environ) avant
+d'abandonner. Une commande prend au plus 1.52 ms (clear display), le double laisse
+de la marge aux clones plus lents. Évite de bloquer pour toujours si le LCD n'est
+pas branché. */
+#define BUSY_TIMEOUT 3000
+
+/* Valeur de OCR2 pour une interruption aux LCD_TICK_US avec un prescaler de 8 */
+#define TICK_OCR (((F_CPU / 8UL) * LCD_TICK_US / 1000000UL) - 1)
+
+/* Délais de la séquence d'initialisation (ceux de la datasheet), en ticks */
+#define US_TO_TICKS(us) (((us) + LCD_TICK_US - 1) / LCD_TICK_US)
+#define POWER_ON_TICKS US_TO_TICKS(15000UL)
+#define FUNCTION_SET_1_TICKS US_TO_TICKS(4100UL)
+#define FUNCTION_SET_2_TICKS US_TO_TICKS(100UL)
+
+/* Adresse de DDRAM du début de la rangée 1 */
+#define LINE_1_ADDRESS 0x40
+
+/* Adresse de DDRAM du début d'une rangée. Les rangées paires sont sur la ligne 0
+du HD44780, les impaires sur la ligne 1. Les rangées 2 et 3 d'un LCD de 4
+rangées continuent donc les rangées 0 et 1 après LCD_NB_COL caractères. */
+#define ROW_ADDRESS(row) ((((row) & 1) * LINE_1_ADDRESS) + (((row) >> 1) * LCD_NB_COL))
+
+/* Le compteur d'adresse du HD44780 n'est pas connu (avant la fin de l'init) */
+#define ADDRESS_UNKNOWN 0xFF
 
 #define MAX_INDEX (LCD_NB_ROW * LCD_NB_COL)
 
+/* Le sous-module text existe en deux versions */
+#ifdef LCD_ENABLE_TEXT_MODULE
+
+#ifdef LCD_TEXT_READ_BACK
+
+#ifdef LCD_ENABLE_FRAMEBUFFER
+#error "LCD_TEXT_READ_BACK n'a pas de sens avec LCD_ENABLE_FRAMEBUFFER, qui garde déjà une copie de l'écran"
+#endif
+
+#define TEXT_READ_BACK
+
+#else
+
+#define TEXT_GAP_BUFFER
+
+#endif
+
+#endif
+
 #define BLANK_CHAR (' ')
 
+/* Une boule pas rapport, pour ce que le LCD ne sait pas afficher */
+#define UNKNOWN_CHAR 0xA5
+
+/* Un caractère Latin-1 qui n'existe pas (contrôle C1). Il s'affiche comme
+UNKNOWN_CHAR et sert aux caractères UTF-8 qui ne sont pas dans Latin-1. */
+#define UNMAPPED_CHAR 0x80
+
 
 /******************************************************************************
 Static variables
 ******************************************************************************/
 
+/* HD44780 */
+
+/* Code de la ROM du HD44780 (A00) pour chaque caractère Latin-1. Les lettres
+accentuées qui n'existent pas dans la ROM perdent leur accent. Convertir un
+caractère ne coûte qu'une lecture en flash, peu importe lequel. */
+static const uint8_t charset[256] PROGMEM = {
+
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5,	// 0x00 CGRAM, 0x08 contrôles
+	0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5,	// 0x10 contrôles
+	0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F,	// 0x20 ASCII
+	0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3A, 0x3B, 0x3C, 0x3D, 0x3E, 0x3F,	// 0x30
+	0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F,	// 0x40
+	0x50, 0x51, 0x52, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0x5B, 0x5C, 0x5D, 0x5E, 0x5F,	// 0x50
+	0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F,	// 0x60
+	0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0x7B, 0x7C, 0x7D, 0x7E, 0x7F,	// 0x70 0x7E et 0x7F sont des flèches
+
+#ifdef ENABLE_JAPANESE_CHAR
+
+	0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x8D, 0x8E, 0x8F,	// 0x80 ROM telle quelle
+	0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B, 0x9C, 0x9D, 0x9E, 0x9F,
+	0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xAA, 0xAB, 0xAC, 0xAD, 0xAE, 0xAF,
+	0xB0, 0xB1, 0xB2, 0xB3, 0xB4, 0xB5, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0xBE, 0xBF,
+	0xC0, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xCA, 0xCB, 0xCC, 0xCD, 0xCE, 0xCF,
+	0xD0, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6, 0xD7, 0xD8, 0xD9, 0xDA, 0xDB, 0xDC, 0xDD, 0xDE, 0xDF,
+	0xE0, 0xE1, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xEA, 0xEB, 0xEC, 0xED, 0xEE, 0xEF,
+	0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0xFA, 0xFB, 0xFC, 0xFD, 0xFE, 0xFF,
+
+#else
+
+	0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5,	// 0x80 contrôles C1
+	0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5,	// 0x90 contrôles C1
+	0x20, 0xA5, 0xA5, 0xA5, 0xA5, 0x5C, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5,	// 0xA0 nbsp, ¥ et ·
+	0xDF, 0xA5, 0xA5, 0xA5, 0xA5, 0xE4, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5, 0xA5,	// 0xB0 ° et µ
+	0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0xA5, 0x43, 0x45, 0x45, 0x45, 0x45, 0x49, 0x49, 0x49, 0x49,	// 0xC0 À - Ï
+	0x44, 0x4E, 0x4F, 0x4F, 0x4F, 0x4F, 0x4F, 0x78, 0x4F, 0x55, 0x55, 0x55, 0x55, 0x59, 0xA5, 0xE2,	// 0xD0 Ð - ß
+	0x61, 0x61, 0x61, 0x61, 0xE1, 0x61, 0xA5, 0x63, 0x65, 0x65, 0x65, 0x65, 0x69, 0x69, 0x69, 0x69,	// 0xE0 à - ï
+	0xA5, 0xEE, 0x6F, 0x6F, 0x6F, 0x6F, 0xEF, 0xFD, 0x6F, 0x75, 0x75, 0x75, 0xF5, 0x79, 0xA5, 0x79,	// 0xF0 ð - ÿ
+
+#endif
+};
+
+/* Copie du compteur d'adresse du HD44780, tenue à jour à chaque envoi plutôt que
+relue. Permet de ne pas envoyer une commande d'adresse qui ne changerait rien. */
+static uint8_t address_counter;
+static bool increment_mode;
+
+/* Copie de la ligne RS, pour ne la changer que lorsque le mode change */
+static bool rs_state;
+
+/* Une lecture de la DDRAM juste après une écriture donne n'importe quoi. Il faut
+qu'une commande d'adresse (ou un déplacement du curseur) ait été envoyée entre
+les deux. */
+static bool read_valid;
+
+#ifdef LCD_ENABLE_MULTIPLE_DISPLAYS
+
+static lcd_display_t* selected_display;
+static uint8_t e_mask;
+
+#endif
+
+#ifdef LCD_ENABLE_ASYNC
+
+/* Chaque envoi prend deux places : le mode (commande ou data) puis le byte */
+static uint8_t queue_buffer[LCD_QUEUE_SIZE];
+static fifo_t queue;
+
+/* Étapes de l'initialisation faite par l'interruption. Tant qu'elle n'est pas
+terminée, la file se remplit sans se vider. */
+typedef enum{
+
+	INIT_POWER_ON = 0,
+	INIT_FUNCTION_SET_1,
+	INIT_FUNCTION_SET_2,
+	INIT_DONE
+
+}init_step_e;
+
+static volatile init_step_e init_step;
+static uint16_t init_ticks;
+
+#endif
+
+
 /* LCD */
 static uint8_t local_index;
 static bool clear_required_flag;
 
+#ifndef LCD_ENABLE_FRAMEBUFFER
+
+/* Nombre de lcd_begin() sans leur lcd_end() */
+static uint8_t transaction_depth;
+
+#endif
+
+
+/* Framebuffer */
+#ifdef LCD_ENABLE_FRAMEBUFFER
+
+/* Les cases sont gardées en codes de la ROM, déjà passés par charset */
+static uint8_t frame_buffer[MAX_INDEX];
+static uint8_t dirty_flags[(MAX_INDEX + 7) / 8];
+
+/* Position du curseur du HD44780 depuis le dernier lcd_refresh() */
+static uint8_t hardware_index;
+
+#endif
+
 
 /* Text */
-#ifdef LCD_ENABLE_TEXT_MODULE
+#ifdef TEXT_GAP_BUFFER
+
+/* Gap buffer : le texte avant le curseur est au début du buffer, le texte après
+le curseur est à la fin. Le trou entre les deux est l'espace libre. Insérer ou
+effacer au curseur ne déplace donc aucun caractère. */
+static char text_buffer[TEXT_BUFFER_SIZE];
+static uint8_t gap_start;
+static uint8_t gap_end;
 
-static char local_data_array[MAX_INDEX];
+/* Où se rendent la ligne du curseur et le reste du texte, en cases */
+typedef struct{
+
+	uint8_t line_end;
+	uint8_t next_line;
+	uint8_t text_end;
+
+}text_layout_t;
 
 #endif
 
@@ -60,63 +258,168 @@ Static prototypes
 ******************************************************************************/
 
 /* hd44780 */
-static void clock_data(char data);
+static void write_command(uint8_t command);
+static void write_data(uint8_t data);
+static void send(bool data_mode, uint8_t byte);
+static void send_now(bool data_mode, uint8_t byte);
+static uint8_t read_status(void);
+static uint8_t clock_read(void);
+static void pulse_enable(void);
+static void wait_busy(void);
+static void set_rs(bool data_mode);
+static void track_shift(bool forward);
+
+#ifdef LCD_ENABLE_ASYNC
+
+static void service_queue(void);
+static void service_init(void);
+static void service_queue_now(void);
+static void flush_queue(void);
+static void enable_tick_interrupt(void);
+
+#endif
 
 
 /* lcd */
+#ifndef ENABLE_JAPANESE_CHAR
+
+static const char* decode_utf8(const char* string, uint16_t* code);
+
+#endif
+
 bool shift_local_index(bool foward);
 uint8_t index_to_col(uint8_t index);
 uint8_t index_to_row(uint8_t index);
 
+#ifndef LCD_ENABLE_FRAMEBUFFER
+
+static void sync_cursor(void);
+
+#endif
+
+
+/* framebuffer */
+#ifdef LCD_ENABLE_FRAMEBUFFER
+
+static void write_cell(uint8_t index, uint8_t code);
+static void fill_frame_buffer(uint8_t code);
+
+#endif
+
 
 /* text */
-#ifdef LCD_ENABLE_TEXT_MODULE
+#ifdef TEXT_GAP_BUFFER
+
+static uint8_t text_length(void);
+static char text_at(uint8_t position);
+static char text_before(uint8_t position);
+static uint8_t next_cell(uint8_t cell, char previous, char character);
+static uint8_t cell_of(uint8_t position);
+static uint8_t position_of(uint8_t cell);
+static void measure(uint8_t position, uint8_t cell, text_layout_t* layout);
+static void move_gap(uint8_t position);
+static bool insert(const char* string, uint8_t length);
+static void redraw_after_edit(uint8_t position, uint8_t cell, const text_layout_t* before);
+static void redraw(uint8_t position, uint8_t cell, uint8_t limit);
+static void place_cursor(void);
+
+#endif
+
+#ifdef TEXT_READ_BACK
+
+static void read_cells(uint8_t index, uint8_t* cells, uint8_t count);
+static void write_cells(uint8_t index, const uint8_t* cells, uint8_t count);
+static bool insert_cells(const uint8_t* cells, uint8_t count);
+static uint8_t insert_limit(uint8_t cursor, uint8_t count);
+static void delete_cell(void);
+static uint8_t delete_limit(uint8_t cursor);
+static uint8_t end_of_text(uint8_t first, uint8_t count);
+
+#endif
 
-void set_cursor_index(uint8_t index);
-void insert(uint8_t index, const char* char_array, uint8_t length);
-void remove(uint8_t index, uint8_t length);
+/******************************************************************************
+Interupts
+******************************************************************************/
+
+#ifdef LCD_ENABLE_ASYNC
+
+/**
+    \brief interupt aux LCD_TICK_US qui envoie le prochain élément de la file
+	lorsque le HD44780 est prêt à le recevoir
+*/
+ISR(TIMER2_COMP_vect){
+
+	service_queue();
+}
 
 #endif
 
+
 /******************************************************************************
 Global functions HD44780
 ******************************************************************************/
 
 void hd44780_init(bool increment, bool cursor, bool blink){
 
+#ifdef LCD_ENABLE_ASYNC
+
+	// Timer 2 en mode CTC. L'interruption n'est activée que lorsque la file
+	// contient quelque chose.
+	reg_clear_bit(TIMSK, OCIE2);
+	TCCR2 = (1 << WGM21) | (1 << CS21);
+	OCR2 = TICK_OCR;
+	TCNT2 = 0;
+
+	fifo_init(&queue, queue_buffer, LCD_QUEUE_SIZE);
+
+#endif
+
+	// Le compteur d'adresse n'est connu qu'à partir du clear display
+	address_counter = ADDRESS_UNKNOWN;
+	read_valid = FALSE;
+
     //On définie la valeur par défaut des ports
     DATA_PORT = FUNCTION_SET;
-    CTRL_PORT = clear_bit(CTRL_PORT, RS_PIN);   //command mode
-    CTRL_PORT = clear_bit(CTRL_PORT, RW_PIN);   //write mode
+    COMMAND_MODE();
+	rs_state = FALSE;
+    WRITE_MODE();
+    FALLING_EDGE();     //E est au repos à 0
 
 	// On change la direction des ports
     DATA_DDR = 0xFF;
-    CTRL_DDR = set_bits(CTRL_DDR, (1 << E_PIN) | (1 << RW_PIN) | (1 << RS_PIN));
+    reg_set_bits(CTRL_DDR, E_MASK | (1 << RW_PIN) | (1 << RS_PIN));
 
-    //initial wait
-    _delay_ms(10);       //10ms
+#ifdef LCD_ENABLE_ASYNC
 
-    FALLING_EDGE();
+	// Les délais sont comptés par l'interruption. Ce qui suit ne fait que
+	// remplir la file, qui sera vidée une fois l'initialisation terminée.
+	init_step = INIT_POWER_ON;
+	init_ticks = POWER_ON_TICKS;
 
-    _delay_ms(5);       //4.1ms /
+	enable_tick_interrupt();
 
-    RISING_EDGE();
+#else
 
-    _delay_ms(5);       //4.1ms /
+    // Tant que les trois premiers function set ne sont pas passés, le busy flag
+    // ne peut pas être lu. Ces délais sont ceux de la datasheet.
 
-    FALLING_EDGE();
+    //initial wait
+    _delay_ms(15);       //15ms après que VCC ait atteint 4.5V
 
-    _delay_us(100);       //100us /
+    pulse_enable();
+
+    _delay_ms(5);       //4.1ms /
 
-    RISING_EDGE();
+    pulse_enable();
 
     _delay_us(100);       //100us /
 
-    FALLING_EDGE();
+    pulse_enable();
 
-    _delay_us(768);       //100us /
+#endif
 
-    RISING_EDGE();
+    // À partir d'ici, chaque envoi attend le busy flag
+    write_command(FUNCTION_SET);
 
     hd44780_set_entry_mode(increment);
     hd44780_set_display_control(TRUE, cursor, blink);
@@ -126,16 +429,15 @@ void hd44780_init(bool increment, bool cursor, bool blink){
 
 void hd44780_clear_display(){
 
-    COMMAND_MODE();
+    write_command(0b00000001);     //Clear Display
 
-    clock_data(0b00000001);     //Clear Display
-	
-	// Cette information n'est nulle part dans la datasheet, mais a plutôt été trouvée
-	// par essaie erreur. Une bonne solution pour régler le problème sera de relire le busy
-	// flag
-	_delay_ms(2);
+	// La fiche technique : le compteur revient à 0 et le mode repasse en incrément
+	address_counter = 0;
+	increment_mode = TRUE;
+	read_valid = FALSE;
 
-    DATA_MODE();
+	// Pas besoin d'attendre ici les 1.52 ms de la commande, la prochaine écriture
+	// va attendre le busy flag.
 }
 
 
@@ -153,11 +455,9 @@ void hd44780_set_entry_mode(bool increment){
         increment_decrement = 0b00000000;
     }
 
-    COMMAND_MODE();
-
-    clock_data(0b00000100 | increment_decrement);     //Entry mode set
+    write_command(0b00000100 | increment_decrement);     //Entry mode set
 
-    DATA_MODE();
+	increment_mode = increment;
 }
 
 
@@ -180,39 +480,26 @@ void hd44780_set_display_control(bool display, bool cursor, bool blink){
         dcb = set_bit(dcb, 0);
     }
 
-    COMMAND_MODE();
-
-    clock_data(0b00001000 | dcb);     //Display on/off control
-
-    DATA_MODE();
+    write_command(0b00001000 | dcb);     //Display on/off control
 }
 
 
 void hd44780_set_cursor_position(uint8_t col, uint8_t row){
 
-    uint8_t address = 0;
+    uint8_t address;
 
-    //On commence par ajouter le offset de la ligne
-    switch(row){
-    case 0:
+    //Le offset de la ligne plus le offset de la colone
+    address = ROW_ADDRESS(row) + col;
 
-        address += 0x00;
-        break;
-
-    case 1:
-
-        address += 0x40;
-        break;
-    }
-
-    //Puis on ajoute le offset de la colone
-    address += col;
-
-    COMMAND_MODE();
+	// Le HD44780 avance tout seul après chaque caractère, il est donc souvent
+	// déjà au bon endroit
+	if(address != address_counter){
 
-    clock_data(0b10000000 | address);     //Set DDRAM address
+		write_command(0b10000000 | address);     //Set DDRAM address
 
-    DATA_MODE();
+		address_counter = address;
+		read_valid = TRUE;
+	}
 }
 
 
@@ -230,247 +517,349 @@ void hd44780_shift_cursor(hd44780_shift_e shift){
         right_left = 0b00000000;
     }
 
-    COMMAND_MODE();
+    write_command(0b00010000 | right_left);     //Cursor or display shift
 
-    clock_data(0b00010000 | right_left);     //Cursor or display shift
+	track_shift(shift == HD44780_SHIFT_RIGHT);
 
-    DATA_MODE();
+	read_valid = TRUE;
 }
 
 
-void hd44780_write_char(char character){
-	
-#ifdef ENABLE_JAPANESE_CHAR
-	const char MAX_CHAR = 255;
-#else
-	const char MAX_CHAR = CHAR_LEFT_ARROW;
-#endif
+void hd44780_shift_display(hd44780_shift_e shift){
 
-    DATA_MODE();
+    uint8_t right_left;
 
-    if((character >= ' ') && (character <= MAX_CHAR)){
+    if(shift == HD44780_SHIFT_RIGHT){
 
-            clock_data(character);
+        right_left = 0b00000100;
     }
 
     else{
-		
-		switch(character){
-		case 0xC0:	//À
-		case 0xC1:	//A accent aigue
-		case 0xC2:	//Â
-		case 0xC3:	//A ???
-		case 0xC4:	//Ä
-			character = 'A';
-			break;
-					
-		case 0xC7:	//Ç
-			character = 'C';
-			break;
-					
-		case 0xC8:	//È
-		case 0xC9:	//É
-		case 0xCA:	//Ê
-		case 0xCB:	//Ë
-			character = 'E';
-			break;
-					
-		case 0xCC:	//Ì
-		case 0xCD:	//I accent aigue
-		case 0xCE:	//Î
-		case 0xCF:	//Ï
-			character = 'I';
-			break;
-					
-		case 0xD2:	//Ò
-		case 0xD3:	//O accent aigue
-		case 0xD4:	//Ô
-		case 0xD5:	//O ???
-		case 0xD6:	//Ö
-			character = 'O';
-			break;
-					
-		case 0xD9:	//Ù
-		case 0xDA:	//U accent aigue
-		case 0xDB:	//Û
-		case 0xDC:	//Ü
-			character = 'U';
-			break;
-					
-		case 0xE0:	//à
-		case 0xE1:	//a accent aigue
-		case 0xE2:	//â
-		case 0xE3:	//a ???
-		case 0xE4:	//ä
-			character = 'a';
-			break;
-		
-		case 0xE7:	//ç
-			character = 'c';
-			break;
-			
-		case 0xE8:	//è
-		case 0xE9:	//é
-		case 0xEA:	//ê
-		case 0xEB:	//ë
-			character = 'e';
-			break;
-			
-		case 0xEC:	//ì
-		case 0xED:	//i accent aigue
-		case 0xEE:	//î
-		case 0xEF:	//ï
-			character = 'i';
-			break;
-			
-		case 0xF2:	//ò
-		case 0xF3:	//o accent aigue
-		case 0xF4:	//ô
-		case 0xF5:	//o ???
-		case 0xF6:	//ö
-			character = 'o';
-			break;
-			
-		case 0xF9:	//ù
-		case 0xFA:	//u accent aigue
-		case 0xFB:	//û
-		case 0xFC:	//ü
-			character = 'u';
-			break;
-		
-		default:
-			character = 0b10100101;  //une boule pas rapport
-			break;
-		}				
 
-        clock_data(character);  //une boule pas rapport
+        right_left = 0b00000000;
     }
-}
 
+    write_command(0b00011000 | right_left);     //Cursor or display shift
+}
 
-/******************************************************************************
-Global functions LCD
-******************************************************************************/
 
-void lcd_init(void){
+void hd44780_return_home(void){
 
-    hd44780_init(TRUE, TRUE, FALSE);
+    write_command(0b00000010);     //Return home
 
-    local_index = 0;
-	clear_required_flag = FALSE;
+	address_counter = 0;
+	read_valid = FALSE;
 }
 
 
-void lcd_clear_display(){
-
-    hd44780_clear_display();
+void hd44780_write_char(char character){
 
-    local_index = 0;
+	// Le cast est nécessaire puisque char est signé
+	hd44780_write_code(pgm_read_byte(&charset[(uint8_t)character]));
 }
 
 
-void lcd_set_cursor_position(uint8_t col, uint8_t row){
+void hd44780_write_code(uint8_t code){
 
-    if((col >= 0) && (col < LCD_NB_COL) && (row >= 0) && (row < LCD_NB_ROW)){
+	write_data(code);
 
-        hd44780_set_cursor_position(col, row);
+	track_shift(increment_mode);
 
-        local_index = col + row * LCD_NB_COL;
-    }
+	read_valid = FALSE;
 }
 
 
-void lcd_shift_cursor(lcd_shift_e shift){
+uint8_t hd44780_read_data(void){
 
-    switch(shift){
-    case LCD_SHIFT_RIGHT:
+	uint8_t data;
 
-        shift_local_index(TRUE);
+	if(read_valid == FALSE){
 
-        break;
+		if(address_counter == ADDRESS_UNKNOWN){
 
-    case LCD_SHIFT_LEFT:
+			hd44780_get_address();
+		}
 
-        shift_local_index(FALSE);
+		write_command(0b10000000 | address_counter);     //Set DDRAM address
 
-        break;
+		read_valid = TRUE;
+	}
 
-    case LCD_SHIFT_UP:
+#ifdef LCD_ENABLE_ASYNC
 
-		// Si on est sur la ligne du haut
-        if(index_to_row(local_index) <= 0){
+	flush_queue();
 
-			// On se rend à la fin moins une ligne
-            local_index += (MAX_INDEX - LCD_NB_COL);
-			
-			clear_required_flag = TRUE;
-        }
+#endif
 
-        else{
-			
-			// On recule d'une ligne
-            local_index -= LCD_NB_COL;
-        }
+	wait_busy();
 
-        break;
+	set_rs(TRUE);
 
-    case LCD_SHIFT_DOWN:
+	data = clock_read();
 
-		// Si on est rendu à la dernière ligne
-        if(index_to_row(local_index) >= LCD_NB_ROW - 1){
+	// Comme une écriture, la lecture avance le compteur d'adresse
+	track_shift(increment_mode);
 
-			// On ne garde que le numéro de colone (donc sa ramène sur la première ligne)
-            local_index %= LCD_NB_COL;
-			
-			clear_required_flag = TRUE;
-        }
+	return data;
+}
 
-        else{
 
-			// On avance d'une ligne
-            local_index += LCD_NB_COL;
-        }
+bool hd44780_is_busy(void){
 
-        break;
-	
-	case LCD_SHIFT_END:
-	
-		local_index = ((index_to_row(local_index) + 1) * LCD_NB_COL) - 1;
-		
-		break;
-		
-	case LCD_SHIFT_START:
-		
-		local_index = index_to_row(local_index) * LCD_NB_COL;
-		
-		break;
-		
-	case LCD_SHIFT_TOP:
-	
-		// On ne garde que le numéro de colone (donc sa ramène sur la première ligne)
-		local_index %= LCD_NB_COL;
-		
-		break;
-		
-	case LCD_SHIFT_BOTTOM:
-		
-		// On se rend à la fin moins une ligne
-		local_index += (MAX_INDEX - LCD_NB_COL);
-		
-		break;
-	}		
+#ifdef LCD_ENABLE_ASYNC
 
-    hd44780_set_cursor_position(index_to_col(local_index), index_to_row(local_index));
-}
+	// Tant que la file n'est pas vide, l'interruption se sert du bus. Une fois
+	// qu'elle est vide, l'interruption n'y touche plus.
+	if((init_step != INIT_DONE) || (fifo_is_empty(&queue) == FALSE)){
 
+		return TRUE;
+	}
 
-void lcd_write_char(char character){
+#endif
 
-    bool unsynced;
+	return read_bit(read_status(), BUSY_FLAG);
+}
+
+
+uint8_t hd44780_get_address(void){
+
+#ifdef LCD_ENABLE_ASYNC
+
+	flush_queue();
+
+#endif
+
+	wait_busy();
+
+	// Le compteur d'adresse est mis à jour un peu (tADD) après que le busy flag
+	// soit tombé.
+	_delay_us(4);
+
+	address_counter = clear_bit(read_status(), BUSY_FLAG);
+
+	return address_counter;
+}
+
+
+void hd44780_write_cgram(uint8_t slot, const uint8_t* bitmap){
+
+	uint8_t address;
+	uint8_t i;
+
+	// L'adresse de CGRAM remplace celle de DDRAM dans le compteur d'adresse, il
+	// faut la remettre après sinon les prochains caractères iraient en CGRAM.
+	// Si on la connaît déjà, pas besoin de vider la file pour la relire.
+	address = address_counter;
+
+	if(address == ADDRESS_UNKNOWN){
+
+		address = hd44780_get_address();
+	}
+
+	write_command(0b01000000 | ((slot & 0x07) << 3));     //Set CGRAM address
+
+	for(i = 0; i < HD44780_CGRAM_HEIGHT; i++){
+
+		write_data(bitmap[i] & 0x1F);
+	}
+
+	write_command(0b10000000 | address);     //Set DDRAM address
+
+	address_counter = address;
+	read_valid = TRUE;
+}
+
+
+/******************************************************************************
+Global functions LCD
+******************************************************************************/
+
+void lcd_init(void){
+
+    hd44780_init(TRUE, TRUE, FALSE);
+
+    local_index = 0;
+	clear_required_flag = FALSE;
+
+#ifndef LCD_ENABLE_FRAMEBUFFER
+
+	transaction_depth = 0;
+
+#endif
+
+#ifdef LCD_ENABLE_FRAMEBUFFER
+
+	// hd44780_init vient d'effacer l'écran, le framebuffer est donc à jour
+	mem_set(frame_buffer, BLANK_CHAR, MAX_INDEX);
+	mem_set(dirty_flags, 0, sizeof(dirty_flags));
+
+	hardware_index = 0;
+
+#endif
+}
+
+
+#ifdef LCD_ENABLE_MULTIPLE_DISPLAYS
+
+void lcd_select(lcd_display_t* display){
+
+	if(selected_display != NULL){
+
+		selected_display->local_index = local_index;
+		selected_display->clear_required_flag = clear_required_flag;
+		selected_display->transaction_depth = transaction_depth;
+		selected_display->address_counter = address_counter;
+		selected_display->increment_mode = increment_mode;
+	}
+
+	local_index = display->local_index;
+	clear_required_flag = display->clear_required_flag;
+	transaction_depth = display->transaction_depth;
+	address_counter = display->address_counter;
+	increment_mode = display->increment_mode;
+
+	e_mask = (1 << display->e_pin);
+
+	// On ne sait pas ce que l'autre LCD a reçu en dernier
+	read_valid = FALSE;
+
+	selected_display = display;
+}
+
+#endif
+
+
+void lcd_clear_display(){
+
+#ifdef LCD_ENABLE_FRAMEBUFFER
+
+	fill_frame_buffer(BLANK_CHAR);
+
+#else
+
+    hd44780_clear_display();
+
+#endif
+
+    local_index = 0;
+}
+
+
+void lcd_set_cursor_position(uint8_t col, uint8_t row){
+
+    if((col >= 0) && (col < LCD_NB_COL) && (row >= 0) && (row < LCD_NB_ROW)){
+
+        local_index = col + row * LCD_NB_COL;
+
+#ifndef LCD_ENABLE_FRAMEBUFFER
+
+		if(transaction_depth == 0){
+
+			sync_cursor();
+		}
+
+#endif
+    }
+}
+
+
+void lcd_shift_cursor(lcd_shift_e shift){
+
+    switch(shift){
+    case LCD_SHIFT_RIGHT:
+
+        shift_local_index(TRUE);
+
+        break;
+
+    case LCD_SHIFT_LEFT:
+
+        shift_local_index(FALSE);
+
+        break;
+
+    case LCD_SHIFT_UP:
+
+		// Si on est sur la ligne du haut
+        if(index_to_row(local_index) <= 0){
+
+			// On se rend à la fin moins une ligne
+            local_index += (MAX_INDEX - LCD_NB_COL);
+			
+			clear_required_flag = TRUE;
+        }
+
+        else{
+			
+			// On recule d'une ligne
+            local_index -= LCD_NB_COL;
+        }
+
+        break;
+
+    case LCD_SHIFT_DOWN:
+
+		// Si on est rendu à la dernière ligne
+        if(index_to_row(local_index) >= LCD_NB_ROW - 1){
+
+			// On ne garde que le numéro de colone (donc sa ramène sur la première ligne)
+            local_index %= LCD_NB_COL;
+			
+			clear_required_flag = TRUE;
+        }
+
+        else{
+
+			// On avance d'une ligne
+            local_index += LCD_NB_COL;
+        }
+
+        break;
 	
+	case LCD_SHIFT_END:
+	
+		local_index = ((index_to_row(local_index) + 1) * LCD_NB_COL) - 1;
+		
+		break;
+		
+	case LCD_SHIFT_START:
+		
+		local_index = index_to_row(local_index) * LCD_NB_COL;
+		
+		break;
+		
+	case LCD_SHIFT_TOP:
+	
+		// On ne garde que le numéro de colone (donc sa ramène sur la première ligne)
+		local_index %= LCD_NB_COL;
+		
+		break;
+		
+	case LCD_SHIFT_BOTTOM:
+		
+		// On se rend à la fin moins une ligne
+		local_index += (MAX_INDEX - LCD_NB_COL);
+		
+		break;
+	}		
+
+#ifndef LCD_ENABLE_FRAMEBUFFER
+
+	if(transaction_depth == 0){
+
+		sync_cursor();
+	}
+
+#endif
+}
+
+
+void lcd_write_char(char character){
+
 	// Si il s'agit d'un des 32 premier caractères ascii, on s'attend à un contrôle
-	// plutôt que l'affichage d'un caractère
-	if(character < ' '){
+	// plutôt que l'affichage d'un caractère. Les premiers sont toutefois les
+	// caractères définis en CGRAM.
+	if(((uint8_t)character < ' ') && ((uint8_t)character >= HD44780_NB_CGRAM_CHAR)){
 		
 		switch (character){
 		case '\n':	// 0x0A	new line
@@ -482,369 +871,1559 @@ void lcd_write_char(char character){
 		}		
 	}
 
-	else{
-		
-		if(clear_required_flag == TRUE){
+	else{
+
+		// Le cast est nécessaire puisque char est signé
+		lcd_write_code(pgm_read_byte(&charset[(uint8_t)character]));
+	}
+}
+
+
+void lcd_write_code(uint8_t code){
+
+	if(clear_required_flag == TRUE){
+		
+#ifdef LCD_ENABLE_FRAMEBUFFER
+		fill_frame_buffer(BLANK_CHAR);
+#else
+		hd44780_clear_display();
+#endif
+		clear_required_flag = FALSE;
+	}
+	
+#ifdef LCD_ENABLE_FRAMEBUFFER
+
+	write_cell(local_index, code);
+
+	// Le curseur du HD44780 sera replacé par lcd_refresh()
+	shift_local_index(TRUE);
+
+#else
+
+	// Dans une transaction, les déplacements du curseur n'ont pas encore été
+	// envoyés. Après un clear display, le HD44780 est revenu à 0. Dans les
+	// autres cas, il est déjà au bon endroit et rien n'est envoyé.
+	sync_cursor();
+
+	hd44780_write_code(code);
+
+	shift_local_index(TRUE);
+
+	// Au bout d'une ligne, le HD44780 ne continue pas sur la suivante
+	if(transaction_depth == 0){
+
+		sync_cursor();
+	}
+
+#endif
+}
+
+
+void lcd_write_string(const char* string){
+
+#ifdef ENABLE_JAPANESE_CHAR
+
+    uint8_t index = 0;
+
+	lcd_begin();
+
+    while(string[index] != '\0'){
+
+        lcd_write_char(string[index]);
+
+        index++;
+    }
+
+	lcd_end();
+
+#else
+
+	uint16_t code;
+
+	lcd_begin();
+
+	while(*string != '\0'){
+
+		string = decode_utf8(string, &code);
+
+		if(code > 0xFF){
+
+			code = UNMAPPED_CHAR;
+		}
+
+		lcd_write_char((char)code);
+	}
+
+	lcd_end();
+
+#endif
+}
+
+
+void lcd_begin(void){
+
+#ifndef LCD_ENABLE_FRAMEBUFFER
+
+	transaction_depth++;
+
+#endif
+}
+
+
+void lcd_end(void){
+
+#ifndef LCD_ENABLE_FRAMEBUFFER
+
+	if(transaction_depth > 0){
+
+		transaction_depth--;
+	}
+
+	// Le curseur affiché doit être à sa position logique en sortant
+	if(transaction_depth == 0){
+
+		sync_cursor();
+	}
+
+#endif
+}
+
+
+void lcd_refresh(void){
+
+#ifdef LCD_ENABLE_FRAMEBUFFER
+
+	uint8_t index;
+
+	for(index = 0; index < MAX_INDEX; index++){
+
+		// Un byte complet de cases propres se saute d'un coup
+		if((index % 8 == 0) && (dirty_flags[index / 8] == 0)){
+
+			index += 7;
+			continue;
+		}
+
+		if(read_bit(dirty_flags[index / 8], index % 8) == 1){
+
+			// Le HD44780 avance tout seul après chaque caractère. On ne le déplace
+			// donc qu'au début d'un groupe de cases modifiées.
+			if(hardware_index != index){
+
+				hd44780_set_cursor_position(index_to_col(index), index_to_row(index));
+			}
+
+			hd44780_write_code(frame_buffer[index]);
+
+			dirty_flags[index / 8] = clear_bit(dirty_flags[index / 8], index % 8);
+
+			// À la fin d'une ligne, la mémoire du HD44780 ne continue pas sur la
+			// ligne suivante. MAX_INDEX force un repositionnement.
+			if(index_to_col(index) == LCD_NB_COL - 1){
+
+				hardware_index = MAX_INDEX;
+			}
+
+			else{
+
+				hardware_index = index + 1;
+			}
+		}
+	}
+
+	if(hardware_index != local_index){
+
+		hd44780_set_cursor_position(index_to_col(local_index), index_to_row(local_index));
+
+		hardware_index = local_index;
+	}
+
+#endif
+}
+
+
+bool lcd_idle(void){
+
+#ifdef LCD_ENABLE_ASYNC
+
+	return ((init_step == INIT_DONE) && (fifo_is_empty(&queue) == TRUE));
+
+#else
+
+	return TRUE;
+
+#endif
+}
+
+
+/** Text *********************************************************************/
+
+#ifdef TEXT_GAP_BUFFER
+
+void text_init(void){
+
+    lcd_init();
+
+    gap_start = 0;
+    gap_end = TEXT_BUFFER_SIZE;
+}
+
+
+void text_clear_display(void){
+
+    lcd_clear_display();
+
+    gap_start = 0;
+    gap_end = TEXT_BUFFER_SIZE;
+}
+
+
+void text_set_cursor_position(uint8_t col, uint8_t row){
+
+    if((col < LCD_NB_COL) && (row < LCD_NB_ROW)){
+
+        move_gap(position_of(col + row * LCD_NB_COL));
+
+        place_cursor();
+    }
+}
+
+
+void text_shift_cursor(lcd_shift_e shift){
+
+    uint8_t cell;
+
+    cell = cell_of(gap_start);
+
+    switch(shift){
+    case LCD_SHIFT_RIGHT:
+
+        if(gap_end < TEXT_BUFFER_SIZE){
+
+            move_gap(gap_start + 1);
+        }
+
+        break;
+
+    case LCD_SHIFT_LEFT:
+
+        if(gap_start > 0){
+
+            move_gap(gap_start - 1);
+        }
+
+        break;
+
+    case LCD_SHIFT_UP:
+
+        if(cell >= LCD_NB_COL){
+
+            move_gap(position_of(cell - LCD_NB_COL));
+        }
+
+        break;
+
+    case LCD_SHIFT_DOWN:
+
+        if(cell + LCD_NB_COL < MAX_INDEX){
+
+            move_gap(position_of(cell + LCD_NB_COL));
+        }
+
+        break;
+
+    case LCD_SHIFT_END:
+
+        move_gap(position_of(cell - index_to_col(cell) + LCD_NB_COL - 1));
+
+        break;
+
+    case LCD_SHIFT_START:
+
+        move_gap(position_of(cell - index_to_col(cell)));
+
+        break;
+
+    case LCD_SHIFT_TOP:
+
+        move_gap(0);
+
+        break;
+
+    case LCD_SHIFT_BOTTOM:
+
+        move_gap(text_length());
+
+        break;
+    }
+
+    place_cursor();
+}
+
+
+bool text_write_char(char character){
+
+    return insert(&character, 1);
+}
+
+
+bool text_line_break(void){
+
+    return text_write_char('\n');
+}
+
+
+void text_del_last_char(void){
+
+    text_layout_t before;
+    uint8_t position;
+    uint8_t cell;
+
+    if(gap_start > 0){
+
+        position = gap_start - 1;
+        cell = cell_of(position);
+
+        measure(position, cell, &before);
+
+        gap_start--;
+
+        redraw_after_edit(position, cell, &before);
+    }
+}
+
+
+void text_del_current_char(void){
+
+    text_layout_t before;
+    uint8_t cell;
+
+    if(gap_end < TEXT_BUFFER_SIZE){
+
+        cell = cell_of(gap_start);
+
+        measure(gap_start, cell, &before);
+
+        gap_end++;
+
+        redraw_after_edit(gap_start, cell, &before);
+    }
+}
+
+
+bool text_write_string(const char* string){
+
+    return insert(string, string_length(string));
+}
+
+
+#endif
+
+
+#ifdef TEXT_READ_BACK
+
+void text_init(void){
+
+    lcd_init();
+}
+
+
+void text_clear_display(void){
+
+    lcd_clear_display();
+}
+
+
+void text_set_cursor_position(uint8_t col, uint8_t row){
+
+    lcd_set_cursor_position(col, row);
+}
+
+
+void text_shift_cursor(lcd_shift_e shift){
+
+    uint8_t cell;
+    uint8_t row_start;
+
+    cell = local_index;
+    row_start = cell - index_to_col(cell);
+
+    switch(shift){
+    case LCD_SHIFT_RIGHT:
+
+        if(cell < MAX_INDEX - 1){
+
+            cell++;
+        }
+
+        break;
+
+    case LCD_SHIFT_LEFT:
+
+        if(cell > 0){
+
+            cell--;
+        }
+
+        break;
+
+    case LCD_SHIFT_UP:
+
+        if(cell >= LCD_NB_COL){
+
+            cell -= LCD_NB_COL;
+        }
+
+        break;
+
+    case LCD_SHIFT_DOWN:
+
+        if(cell + LCD_NB_COL < MAX_INDEX){
+
+            cell += LCD_NB_COL;
+        }
+
+        break;
+
+    case LCD_SHIFT_END:
+
+        cell = end_of_text(row_start, LCD_NB_COL);
+
+        break;
+
+    case LCD_SHIFT_START:
+
+        cell = row_start;
+
+        break;
+
+    case LCD_SHIFT_TOP:
+
+        cell = 0;
+
+        break;
+
+    case LCD_SHIFT_BOTTOM:
+
+        cell = end_of_text(0, MAX_INDEX);
+
+        break;
+    }
+
+    lcd_set_cursor_position(index_to_col(cell), index_to_row(cell));
+}
+
+
+bool text_write_char(char character){
+
+    uint8_t code;
+
+    if(character == '\n'){
+
+        return text_line_break();
+    }
+
+    code = pgm_read_byte(&charset[(uint8_t)character]);
+
+    return insert_cells(&code, 1);
+}
+
+
+bool text_line_break(void){
+
+    uint8_t cells[LCD_NB_COL];
+    uint8_t count;
+
+    // Après une rangée pleine, le curseur est déjà au début de la suivante. Comme
+    // avec le gap buffer, le '\n' ne saute pas une autre rangée.
+    if((index_to_col(local_index) == 0) && (local_index > 0)){
+
+        read_cells(local_index - 1, cells, 1);
+
+        // La lecture a déplacé le curseur du HD44780
+        sync_cursor();
+
+        if(cells[0] != BLANK_CHAR){
+
+            return TRUE;
+        }
+    }
+
+    // Il n'y a pas de rangée suivante où envoyer la suite
+    if(index_to_row(local_index) >= LCD_NB_ROW - 1){
+
+        return FALSE;
+    }
+
+    // La suite de la ligne est poussée au début de la rangée suivante
+    count = LCD_NB_COL - index_to_col(local_index);
+
+    mem_set(cells, BLANK_CHAR, count);
+
+    return insert_cells(cells, count);
+}
+
+
+void text_del_last_char(void){
+
+    if(local_index > 0){
+
+        lcd_set_cursor_position(index_to_col(local_index - 1), index_to_row(local_index - 1));
+
+        delete_cell();
+    }
+}
+
+
+void text_del_current_char(void){
+
+    delete_cell();
+}
+
+
+bool text_write_string(const char* string){
+
+    uint8_t cells[LCD_NB_COL];
+    uint8_t count;
+    uint8_t i;
+
+    while(*string != '\0'){
+
+        // Les caractères jusqu'au prochain '\n' sont insérés d'un coup, par
+        // groupes d'au plus une rangée
+        count = 0;
+
+        while((*string != '\0') && (*string != '\n') && (count < LCD_NB_COL)){
+
+            cells[count] = pgm_read_byte(&charset[(uint8_t)*string]);
+
+            count++;
+            string++;
+        }
+
+        if(count == 0){
+
+            if(text_line_break() == FALSE){
+
+                return FALSE;
+            }
+
+            string++;
+        }
+
+        else if(insert_cells(cells, count) == FALSE){
+
+            // Le groupe ne tient pas au complet, on en met autant que possible
+            for(i = 0; i < count; i++){
+
+                if(insert_cells(&cells[i], 1) == FALSE){
+
+                    break;
+                }
+            }
+
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+#endif
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* hd44780 */
+static void write_command(uint8_t command){
+
+	send(FALSE, command);
+}
+
+
+static void write_data(uint8_t data){
+
+	send(TRUE, data);
+}
+
+
+/* Toutes les écritures au HD44780 passent par ici */
+static void send(bool data_mode, uint8_t byte){
+
+#ifdef LCD_ENABLE_ASYNC
+
+	bool queued = FALSE;
+
+	while(queued == FALSE){
+
+		// Pendant qu'on touche à la file, l'interruption ne doit pas s'en servir
+		reg_clear_bit(TIMSK, OCIE2);
+
+		if(fifo_get_free_space(&queue) >= 2){
+
+			fifo_push(&queue, data_mode);
+			fifo_push(&queue, byte);
+
+			queued = TRUE;
+		}
+
+		enable_tick_interrupt();
+
+		// Si la file est pleine et que les interruptions sont désactivées, elle
+		// ne se videra jamais toute seule. On fait donc le travail du ISR.
+		if((queued == FALSE) && (read_bit(SREG, SREG_I) == 0)){
+
+			service_queue_now();
+		}
+	}
+
+#else
+
+	// Plutôt que d'attendre le pire cas de chaque commande après l'avoir envoyée,
+	// on attend avant la suivante seulement le temps que le HD44780 est réellement
+	// occupé. Ça laisse le temps au code de faire autre chose entre deux envois.
+	wait_busy();
+
+	send_now(data_mode, byte);
+
+#endif
+}
+
+
+/* Envoie sans vérifier le busy flag */
+static void send_now(bool data_mode, uint8_t byte){
+
+	set_rs(data_mode);
+
+    DATA_PORT = byte;
+
+    pulse_enable();
+}
+
+
+static uint8_t read_status(void){
+
+	set_rs(FALSE);
+
+	return clock_read();
+}
+
+
+/* Lit le bus avec le RS actuel. RS = 0 donne le busy flag et le compteur
+d'adresse, RS = 1 donne le contenu de la DDRAM ou de la CGRAM. */
+static uint8_t clock_read(void){
+
+	uint8_t data;
+
+	// On vire le bus de bord avant que le HD44780 ne le pilote
+	DATA_DDR = 0x00;
+	DATA_PORT = 0x00;	// pas de pull-up
+	READ_MODE();
+
+	RISING_EDGE();
+
+	_delay_us(1);		// tDDR : 360 ns maximum avant que la donnée soit valide
+
+	data = DATA_PIN;
+
+	FALLING_EDGE();
+
+	// Le HD44780 relâche le bus dès que E est à 0
+	WRITE_MODE();
+	DATA_DDR = 0xFF;
+
+	return data;
+}
+
+
+static void pulse_enable(void){
+
+	RISING_EDGE();
+
+	_delay_us(1);		// PWEH : 230 ns minimum
+
+	FALLING_EDGE();		// Le HD44780 lit le bus sur le front descendant
+}
+
+
+static void wait_busy(void){
+
+	uint16_t timeout = BUSY_TIMEOUT;
+
+	while((read_bit(read_status(), BUSY_FLAG) == 1) && (timeout > 0)){
+
+		timeout--;
+	}
+}
+
+
+/* Le busy flag se lit avec RS à 0. Lors d'une attente, ou d'une suite de
+commandes, RS ne bouge donc plus après la première lecture. */
+static void set_rs(bool data_mode){
+
+	if(data_mode != rs_state){
+
+		if(data_mode == TRUE){
+
+			DATA_MODE();
+		}
+
+		else{
+
+			COMMAND_MODE();
+		}
+
+		rs_state = data_mode;
+	}
+}
+
+
+/* Suit le compteur d'adresse après un caractère ou un déplacement du curseur. En
+mode deux lignes, la fin de la rangée 0 en DDRAM continue au début de la rangée 1
+et inversement. */
+static void track_shift(bool forward){
+
+	if(address_counter == ADDRESS_UNKNOWN){
+
+		return;
+	}
+
+	if(forward == TRUE){
+
+		if(address_counter == HD44780_LINE_SIZE - 1){
+
+			address_counter = LINE_1_ADDRESS;
+		}
+
+		else if(address_counter == LINE_1_ADDRESS + HD44780_LINE_SIZE - 1){
+
+			address_counter = 0;
+		}
+
+		else{
+
+			address_counter++;
+		}
+	}
+
+	else{
+
+		if(address_counter == 0){
+
+			address_counter = LINE_1_ADDRESS + HD44780_LINE_SIZE - 1;
+		}
+
+		else if(address_counter == LINE_1_ADDRESS){
+
+			address_counter = HD44780_LINE_SIZE - 1;
+		}
+
+		else{
+
+			address_counter--;
+		}
+	}
+}
+
+
+#ifdef LCD_ENABLE_ASYNC
+
+/* Appelée par le ISR, ou directement lorsque les interruptions sont désactivées */
+static void service_queue(void){
+
+	bool data_mode;
+	uint8_t byte;
+
+	if(init_step != INIT_DONE){
+
+		service_init();
+	}
+
+	else if(fifo_is_empty(&queue) == TRUE){
+
+		// Plus rien à faire, inutile de se faire réveiller pour rien
+		reg_clear_bit(TIMSK, OCIE2);
+	}
+
+	// Si le HD44780 est encore occupé, on réessaie au prochain tick
+	else if(read_bit(read_status(), BUSY_FLAG) == 0){
+
+		data_mode = fifo_pop(&queue);
+		byte = fifo_pop(&queue);
+
+		send_now(data_mode, byte);
+	}
+}
+
+
+/* Un tick de la séquence d'initialisation. Le busy flag ne peut pas encore être
+lu, les trois premiers function set sont donc envoyés à l'aveugle après leur
+délai. */
+static void service_init(void){
+
+	init_ticks--;
+
+	if(init_ticks == 0){
+
+		send_now(FALSE, FUNCTION_SET);
+
+		init_step++;
+
+		switch(init_step){
+		case INIT_FUNCTION_SET_1:
+
+			init_ticks = FUNCTION_SET_1_TICKS;
+			break;
+
+		case INIT_FUNCTION_SET_2:
+
+			init_ticks = FUNCTION_SET_2_TICKS;
+			break;
+
+		default:
+
+			break;
+		}
+	}
+}
+
+
+/* Fait le travail du ISR lorsque les interruptions sont désactivées */
+static void service_queue_now(void){
+
+	// Sans l'interruption, c'est ce délai qui compte les ticks de l'initialisation
+	if(init_step != INIT_DONE){
+
+		_delay_us(LCD_TICK_US);
+	}
+
+	service_queue();
+}
+
+
+static void flush_queue(void){
+
+	while((init_step != INIT_DONE) || (fifo_is_empty(&queue) == FALSE)){
+
+		if(read_bit(SREG, SREG_I) == 0){
+
+			service_queue_now();
+		}
+	}
+}
+
+
+static void enable_tick_interrupt(void){
+
+	uint8_t sreg_backup;
+
+	// TIMSK est partagé avec les autres timers. Si une interruption le modifiait
+	// entre la lecture et l'écriture, sa modification serait perdue.
+	sreg_backup = SREG;
+	cli();
+
+	reg_set_bit(TIMSK, OCIE2);
+
+	SREG = sreg_backup;
+}
+
+#endif
+
+
+/* lcd */
+#ifndef ENABLE_JAPANESE_CHAR
+
+/* Lit un caractère UTF-8 et retourne un pointeur sur le suivant. Un byte qui ne
+forme pas une séquence UTF-8 valide est pris comme un caractère Latin-1, ce qui
+permet aussi d'afficher des strings écrites en Latin-1. */
+static const char* decode_utf8(const char* string, uint16_t* code){
+
+	uint8_t lead;
+	uint8_t length;
+	uint8_t i;
+
+	lead = (uint8_t)string[0];
+
+	if(lead < 0x80){
+
+		length = 1;
+		*code = lead;
+	}
+
+	else if((lead & 0xE0) == 0xC0){
+
+		length = 2;
+		*code = lead & 0x1F;
+	}
+
+	else if((lead & 0xF0) == 0xE0){
+
+		length = 3;
+		*code = lead & 0x0F;
+	}
+
+	// Hors du plan multilingue de base, rien de tout ça n'existe dans la ROM
+	else if((lead & 0xF8) == 0xF0){
+
+		length = 4;
+		*code = 0xFFFF;
+	}
+
+	else{
+
+		length = 1;
+		*code = lead;
+	}
+
+	for(i = 1; i < length; i++){
+
+		// Le '\0' échoue aussi ce test, on ne lit donc jamais après la fin
+		if(((uint8_t)string[i] & 0xC0) != 0x80){
+
+			*code = lead;
+
+			return string + 1;
+		}
+
+		if(length < 4){
+
+			*code = (*code << 6) | ((uint8_t)string[i] & 0x3F);
+		}
+	}
+
+	return string + length;
+}
+
+#endif
+
+
+uint8_t index_to_col(uint8_t index){
+
+    return index % LCD_NB_COL;
+}
+
+
+uint8_t index_to_row(uint8_t index){
+
+    return index / LCD_NB_COL;
+}
+
+bool shift_local_index(bool foward){
+
+    uint8_t previous_row;
+
+    previous_row = index_to_row(local_index);
+
+    /* Si on est dans le sens foward */
+    if(foward == TRUE){
+
+        /* Si on est à la fin */
+        if(local_index >= MAX_INDEX - 1){
+
+			local_index = 0;
+        }
+
+        else{
+
+            local_index++;
+        }
+    }
+
+    /* Si on est dans le sens décrémental foward ou incrémental backward*/
+    else{
+
+        /* Si on est au début */
+        if(local_index <= 0){
 			
-			hd44780_clear_display();
-			//hd44780_set_cursor_position(index_to_col(local_index), index_to_row(local_index));
-			clear_required_flag = FALSE;
-		}
-		
-		hd44780_write_char(character);
+            local_index = MAX_INDEX - 1;
+        }
 
-		unsynced = shift_local_index(TRUE);
+        else{
 
-		if(unsynced == TRUE){
+            local_index--;
+        }
+    }
 
-			hd44780_set_cursor_position(index_to_col(local_index), index_to_row(local_index));
-		}
+    /* Si la row actuelle ne correspond pas à l'ancienne il va falloir manuellement
+    déplacer le curseur */
+    return (previous_row != index_to_row(local_index));
+}
+
+
+#ifndef LCD_ENABLE_FRAMEBUFFER
+
+/* Amène le curseur du HD44780 à la position logique. Ne coûte rien s'il y est
+déjà. */
+static void sync_cursor(void){
+
+	hd44780_set_cursor_position(index_to_col(local_index), index_to_row(local_index));
+}
+
+#endif
+
+
+/* framebuffer */
+#ifdef LCD_ENABLE_FRAMEBUFFER
+
+static void write_cell(uint8_t index, uint8_t code){
+
+	// Réécrire le même caractère ne coûte rien au prochain lcd_refresh()
+	if(frame_buffer[index] != code){
+
+		frame_buffer[index] = code;
+
+		dirty_flags[index / 8] = set_bit(dirty_flags[index / 8], index % 8);
 	}
 }
 
 
-void lcd_write_string(const char* string){
+static void fill_frame_buffer(uint8_t code){
 
-    uint8_t index = 0;
+	uint8_t i;
 
-    while(string[index] != '\0'){
+	for(i = 0; i < MAX_INDEX; i++){
 
-        lcd_write_char(string[index]);
+		write_cell(i, code);
+	}
+}
 
-        index++;
-    }
+#endif
+
+
+/* text */
+#ifdef TEXT_GAP_BUFFER
+
+static uint8_t text_length(void){
+
+	return gap_start + (TEXT_BUFFER_SIZE - gap_end);
 }
 
 
-/** Text *********************************************************************/
+/* Le caractère à une position du texte, comme si le trou n'existait pas */
+static char text_at(uint8_t position){
 
-#ifdef LCD_ENABLE_TEXT_MODULE
+	if(position < gap_start){
 
-void text_init(void){
+		return text_buffer[position];
+	}
 
-    uint8_t i;
+	return text_buffer[position + (gap_end - gap_start)];
+}
 
-    lcd_init(FALSE);
 
-    for(i = 0; i < LCD_NB_ROW * LCD_NB_COL; i++){
+/* Le caractère avant une position. Le début du texte compte comme un '\n'. */
+static char text_before(uint8_t position){
 
-        local_data_array[i] = BLANK_CHAR;
-    }
+	if(position == 0){
+
+		return '\n';
+	}
+
+	return text_at(position - 1);
 }
 
 
-void text_clear_display(void){
+/* La case où va le caractère qui suit. Un '\n' n'occupe pas de case, il envoie
+la suite au début de la rangée suivante. Si le caractère précédent a rempli sa
+rangée, la suite y est déjà et le '\n' n'avance pas d'une autre rangée. */
+static uint8_t next_cell(uint8_t cell, char previous, char character){
 
-    uint8_t i;
+	if(character == '\n'){
 
-    lcd_clear_display();
+		if((index_to_col(cell) == 0) && (previous != '\n')){
 
-    for(i = 0; i < MAX_INDEX; i++){
+			return cell;
+		}
 
-        local_data_array[i] = BLANK_CHAR;
-    }
+		return cell - index_to_col(cell) + LCD_NB_COL;
+	}
+
+	return cell + 1;
 }
 
 
-void text_set_cursor_position(uint8_t col, uint8_t row){
+/* La case où s'affiche le caractère à cette position (ou le curseur, s'il y est) */
+static uint8_t cell_of(uint8_t position){
 
-    lcd_set_cursor_position(col, row);
+	uint8_t cell = 0;
+	uint8_t i;
+
+	for(i = 0; i < position; i++){
+
+		cell = next_cell(cell, text_before(i), text_at(i));
+	}
+
+	return cell;
 }
 
 
-void text_shift_cursor(lcd_shift_e shift){
+/* La dernière position du texte qui s'affiche au plus tard dans cette case */
+static uint8_t position_of(uint8_t cell){
+
+	uint8_t length;
+	uint8_t current = 0;
+	uint8_t i;
+
+	length = text_length();
+
+	for(i = 0; i < length; i++){
+
+		current = next_cell(current, text_before(i), text_at(i));
+
+		if(current > cell){
 
-    lcd_shift_cursor(shift);
+			break;
+		}
+	}
+
+	return i;
 }
 
 
-void text_write_char(char character){
+static void measure(uint8_t position, uint8_t cell, text_layout_t* layout){
 
-    uint8_t local_index_backup;
+	uint8_t length;
 
-    local_index_backup = local_index;
+	length = text_length();
 
-    insert(local_index, &character, 1);
+	// La ligne courante s'arrête au premier '\n'
+	while((position < length) && (text_at(position) != '\n')){
 
-    local_index_backup++;
+		cell++;
+		position++;
+	}
 
-    /* Si le curseur est passé la dernière position */
-    if(local_index_backup >= MAX_INDEX){
+	layout->line_end = cell;
 
-        text_line_break();
-    }
+	if(position < length){
 
-    else{
+		cell = next_cell(cell, text_before(position), '\n');
+		position++;
+	}
 
-        set_cursor_index(local_index_backup);
-    }
-}
+	layout->next_line = cell;
 
+	while(position < length){
+
+		cell = next_cell(cell, text_before(position), text_at(position));
+		position++;
+	}
 
-void text_line_break(void){
+	layout->text_end = cell;
+}
 
-    uint8_t local_index_backup;
-    uint8_t offset;
-    char space_array[LCD_NB_COL];
 
-    uint8_t i;
+/* Déplacer le trou ne change rien à l'affichage, seul le curseur bouge */
+static void move_gap(uint8_t position){
 
-    /* Si le curseur est sur la dernière ligne ou même sur la troisième ligne virtuelle */
-    if(index_to_row(local_index) >= LCD_NB_ROW - 1){
+	uint8_t count;
 
-        local_index_backup = local_index;
+	if(gap_start > position){
 
-        /* On commence par supprimer la première ligne */
-        remove(0, LCD_NB_COL);
+		count = gap_start - position;
+		gap_start -= count;
+		gap_end -= count;
 
-        set_cursor_index(local_index_backup - LCD_NB_COL);
-    }
+		mem_move(&text_buffer[gap_end], &text_buffer[gap_start], count);
+	}
 
-    if(local_index < LCD_NB_COL){
+	else if(gap_start < position){
 
-        offset = LCD_NB_COL - index_to_col(local_index);
+		count = position - gap_start;
 
-        /* On rempli l'array d'espace */
-        for(i = 0; i < offset; i++){
+		if(count > TEXT_BUFFER_SIZE - gap_end){
 
-            space_array[i] = '\n';
-        }
+			count = TEXT_BUFFER_SIZE - gap_end;
+		}
 
-        /* On insert cet array */
-        insert(local_index, space_array, offset);
+		mem_move(&text_buffer[gap_start], &text_buffer[gap_end], count);
 
-        set_cursor_index(LCD_NB_COL);
-    }
+		gap_start += count;
+		gap_end += count;
+	}
 }
 
 
-void text_del_last_char(void){
+static bool insert(const char* string, uint8_t length){
 
-    uint8_t local_index_backup;
-    uint8_t length;
+	text_layout_t before;
+	text_layout_t after;
+	uint8_t position;
+	uint8_t cell;
+	uint8_t i = 0;
 
-    local_index_backup = local_index;
-    length = 1;
+	position = gap_start;
+	cell = cell_of(position);
 
-    while((local_index > 0) && (local_data_array[local_index - 1] == '\n')){
+	measure(position, cell, &before);
 
-        local_index--;
-        length++;
-    }
+	while((i < length) && (gap_start < gap_end)){
+
+		text_buffer[gap_start] = string[i];
+		gap_start++;
+		i++;
+	}
 
-    /* Si aucun sauts de lignes n'ont été découverts */
-    if(local_index_backup == local_index){
+	// Ce qui ne tient pas à l'écran est retiré, en commençant par la fin
+	measure(position, cell, &after);
 
-        /* Il faut quand même supprimer un caractère */
-        local_index--;
-    }
+	while((after.text_end > MAX_INDEX) && (gap_start > position)){
 
-    /* On met à jour notre référence */
-    local_index_backup = local_index;
+		gap_start--;
+		i--;
+
+		measure(position, cell, &after);
+	}
 
-    remove(local_index, length);
+	redraw_after_edit(position, cell, &before);
 
-    set_cursor_index(local_index_backup);
+	return (i == length);
 }
 
 
-void text_del_current_char(void){
+/* Seules les cases qui ont pu changer sont réécrites : le reste de la ligne
+courante, ou le reste du texte si le début de la ligne suivante a bougé. */
+static void redraw_after_edit(uint8_t position, uint8_t cell, const text_layout_t* before){
 
-    uint8_t local_index_backup;
-    uint8_t length;
+	text_layout_t after;
+	uint8_t limit;
 
-    local_index_backup = local_index;
-    length = 1;
+	measure(position, cell, &after);
 
-    while((local_index + length < MAX_INDEX) && (local_data_array[local_index + length] == '\n')){
+	if(after.next_line == before->next_line){
 
-        length++;
-    }
+		limit = after.line_end;
+
+		if(before->line_end > limit){
+
+			limit = before->line_end;
+		}
+	}
+
+	else{
+
+		limit = after.text_end;
+
+		if(before->text_end > limit){
+
+			limit = before->text_end;
+		}
+	}
 
-    remove(local_index, length);
+	redraw(position, cell, limit);
 
-    set_cursor_index(local_index_backup);
+	place_cursor();
 }
 
 
-void text_write_string(const char* string){
+/* Écrit le texte à partir d'une position jusqu'à la case limit. Les cases sont
+écrites d'un seul trait, le HD44780 avançant son adresse tout seul. */
+static void redraw(uint8_t position, uint8_t cell, uint8_t limit){
 
-    uint8_t local_index_backup;
-    uint8_t index = 0;
-    uint8_t i = 0;
+	uint8_t length;
+	uint8_t end_of_row;
 
-    while(string[i] != '\0'){
+	if(limit > MAX_INDEX){
+
+		limit = MAX_INDEX;
+	}
 
-        /* Si on trouve un line break */
-        if(string[i] == '\n'){
+	if(cell >= limit){
 
-            local_index_backup = local_index;
+		return;
+	}
 
-            insert(local_index, &(string[index]), i - index);
+	length = text_length();
 
-            set_cursor_index(local_index_backup + i);
+	lcd_set_cursor_position(index_to_col(cell), index_to_row(cell));
 
-            text_line_break();
+	while(cell < limit){
 
-            index = i + 1;
-        }
+		if((position < length) && (text_at(position) != '\n')){
 
-        i++;
-    }
+			lcd_write_char(text_at(position));
+			cell++;
+		}
 
-    local_index_backup = local_index;
+		else{
 
-    insert(local_index, &(string[index]), i - index);
+			// Après un '\n' ou après la fin du texte, il ne reste que des espaces
+			end_of_row = next_cell(cell, text_before(position), '\n');
 
-    set_cursor_index(local_index_backup + i);
+			if(position >= length){
+
+				end_of_row = limit;
+			}
+
+			while((cell < end_of_row) && (cell < limit)){
+
+				lcd_write_char(BLANK_CHAR);
+				cell++;
+			}
+		}
+
+		position++;
+	}
 }
 
 
+static void place_cursor(void){
+
+	uint8_t cell;
+
+	cell = cell_of(gap_start);
+
+	// Quand l'écran est plein, le curseur reste sur la dernière case
+	if(cell >= MAX_INDEX){
+
+		cell = MAX_INDEX - 1;
+	}
+
+	lcd_set_cursor_position(index_to_col(cell), index_to_row(cell));
+}
+
 #endif
 
 
-/******************************************************************************
-Static functions
-******************************************************************************/
+#ifdef TEXT_READ_BACK
 
-/* hd44780 */
-void clock_data(char data){
+/* Les cases se lisent et s'écrivent en codes de la ROM, pour que les caractères
+déplacés ne repassent pas par charset. Le HD44780 avance tout seul d'une case à
+l'autre, une commande d'adresse n'est envoyée qu'au changement de rangée. */
+static void read_cells(uint8_t index, uint8_t* cells, uint8_t count){
 
-    DATA_PORT = data;
+	uint8_t i;
 
-    _delay_us(50);
+	for(i = 0; i < count; i++){
 
-    FALLING_EDGE();
+		hd44780_set_cursor_position(index_to_col(index), index_to_row(index));
 
-    _delay_us(50);
+		cells[i] = hd44780_read_data();
 
-    RISING_EDGE();
+		index++;
+	}
 }
 
 
-/* lcd */
+static void write_cells(uint8_t index, const uint8_t* cells, uint8_t count){
 
-uint8_t index_to_col(uint8_t index){
+	uint8_t i;
 
-    return index % LCD_NB_COL;
-}
+	for(i = 0; i < count; i++){
 
+		hd44780_set_cursor_position(index_to_col(index), index_to_row(index));
 
-uint8_t index_to_row(uint8_t index){
+		hd44780_write_code(cells[i]);
 
-    return index / LCD_NB_COL;
+		index++;
+	}
 }
 
-bool shift_local_index(bool foward){
 
-    uint8_t previous_row;
+/* Insère count cases (au plus une rangée) au curseur et pousse la suite de la
+rangée. Les espaces à la fin de la rangée absorbent l'insertion. Seule une rangée
+qui n'en a pas assez déborde sur la suivante, et ainsi de suite. Rien n'est fait
+si des caractères tomberaient au bout de l'écran. */
+static bool insert_cells(const uint8_t* cells, uint8_t count){
 
-    previous_row = index_to_row(local_index);
+	uint8_t moved[LCD_NB_COL];
+	uint8_t cursor;
+	uint8_t limit;
+	uint8_t start;
+	uint8_t end;
+	uint8_t length;
+	bool trailing_blank;
 
-    /* Si on est dans le sens foward */
-    if(foward == TRUE){
+	cursor = local_index;
 
-        /* Si on est à la fin */
-        if(local_index >= MAX_INDEX - 1){
+	limit = insert_limit(cursor, count);
 
-			local_index = 0;
-        }
+	if(limit == 0){
 
-        else{
+		// La lecture a déplacé le curseur du HD44780
+		sync_cursor();
 
-            local_index++;
-        }
-    }
+		return FALSE;
+	}
 
-    /* Si on est dans le sens décrémental foward ou incrémental backward*/
-    else{
+	// On déplace par groupes en partant de la fin, pour ne rien écraser qui n'a
+	// pas encore été lu. Tant que tout ce qui suit est vide, les espaces à la fin
+	// d'un groupe n'ont pas besoin d'être réécrits.
+	trailing_blank = TRUE;
+	end = limit - count;
 
-        /* Si on est au début */
-        if(local_index <= 0){
-			
-            local_index = MAX_INDEX - 1;
-        }
+	while(end > cursor){
 
-        else{
+		start = cursor;
 
-            local_index--;
-        }
-    }
+		if(end - cursor > LCD_NB_COL){
 
-    /* Si la row actuelle ne correspond pas à l'ancienne il va falloir manuellement
-    déplacer le curseur */
-    return (previous_row != index_to_row(local_index));
+			start = end - LCD_NB_COL;
+		}
+
+		length = end - start;
+
+		read_cells(start, moved, length);
+
+		if(trailing_blank == TRUE){
+
+			while((length > 0) && (moved[length - 1] == BLANK_CHAR)){
+
+				length--;
+			}
+
+			trailing_blank = (length == 0);
+		}
+
+		write_cells(start + count, moved, length);
+
+		end = start;
+	}
+
+	write_cells(cursor, cells, count);
+
+	cursor += count;
+
+	if(cursor >= MAX_INDEX){
+
+		cursor = MAX_INDEX - 1;
+	}
+
+	lcd_set_cursor_position(index_to_col(cursor), index_to_row(cursor));
+
+	return TRUE;
 }
 
 
-/* text */
-#ifdef LCD_ENABLE_TEXT_MODULE
+/* La fin de la zone à décaler pour insérer count cases au curseur : la fin de la
+première rangée, à partir de celle du curseur, dont les count dernières cases sont
+des espaces qui suivent le curseur. 0 si aucune rangée ne peut absorber
+l'insertion. */
+static uint8_t insert_limit(uint8_t cursor, uint8_t count){
+
+	uint8_t cells[LCD_NB_COL];
+	uint8_t row_end;
+	uint8_t i;
+
+	row_end = cursor - index_to_col(cursor) + LCD_NB_COL;
+
+	while(row_end <= MAX_INDEX){
+
+		if(row_end - count >= cursor){
+
+			read_cells(row_end - count, cells, count);
+
+			i = 0;
 
-void set_cursor_index(uint8_t index){
+			while((i < count) && (cells[i] == BLANK_CHAR)){
 
-	if((index >= 0) && (index < MAX_INDEX)){
+				i++;
+			}
 
-		hd44780_set_cursor_position(index % LCD_NB_COL, index / LCD_NB_COL);
+			if(i == count){
 
-		local_index = index;
+				return row_end;
+			}
+		}
+
+		row_end += LCD_NB_COL;
 	}
+
+	return 0;
 }
 
-void insert(uint8_t index, const char* char_array, uint8_t length){
 
-    /* Très exceptionellement, le type doit être signé pour empêcher la dernière
-    boucle for de spinner à l'infini */
-    int8_t i;
+/* Efface la case du curseur et ramène la suite de la rangée d'une case. Une
+rangée pleine ramène aussi le début de la suivante, comme le ferait un texte qui
+continue d'une rangée à l'autre. */
+static void delete_cell(void){
 
-    if(index + length < MAX_INDEX){
+	uint8_t moved[LCD_NB_COL];
+	uint8_t cursor;
+	uint8_t limit;
+	uint8_t start;
+	uint8_t length;
 
-        set_cursor_index(MAX_INDEX - 1);
+	cursor = local_index;
+	start = cursor;
 
-        lcd_set_entry_mode(FALSE);
+	limit = delete_limit(cursor);
 
-        for(i = (MAX_INDEX - 1); i >= index; i--){
+	while(start + 1 < limit){
 
-            /* Décalage des caractères */
-            if(i >= index + length){
+		length = limit - (start + 1);
 
-                local_data_array[i] = local_data_array[i - length];
-            }
+		if(length > LCD_NB_COL){
 
-            /* Insertion des nouveaux caractères */
-            else{
+			length = LCD_NB_COL;
+		}
 
-                local_data_array[i] = char_array[i - index];
-            }
+		read_cells(start + 1, moved, length);
+		write_cells(start, moved, length);
 
-            lcd_write_char(local_data_array[i]);
-        }
+		start += length;
+	}
 
-        lcd_set_entry_mode(TRUE);
-    }
+	moved[0] = BLANK_CHAR;
+	write_cells(limit - 1, moved, 1);
+
+	lcd_set_cursor_position(index_to_col(cursor), index_to_row(cursor));
 }
 
 
-void remove(uint8_t index, uint8_t length){
+/* La fin de la zone ramenée par un effacement au curseur : la fin de la première
+rangée, à partir de celle du curseur, qui se termine par un espace */
+static uint8_t delete_limit(uint8_t cursor){
 
-    uint8_t i;
+	uint8_t row_end;
+	uint8_t code;
 
-    set_cursor_index(index);
+	row_end = cursor - index_to_col(cursor) + LCD_NB_COL;
 
-    /* Décalage des caractères */
-    for(i = index; i < MAX_INDEX; i++){
+	while(row_end < MAX_INDEX){
 
-        if(i < MAX_INDEX - length){
+		read_cells(row_end - 1, &code, 1);
 
-            local_data_array[i] = local_data_array[i + length];
-        }
+		if(code == BLANK_CHAR){
 
-        else{
+			return row_end;
+		}
 
-            local_data_array[i] = BLANK_CHAR;
-        }
+		row_end += LCD_NB_COL;
+	}
 
-        lcd_write_char(local_data_array[i]);
-    }
+	return MAX_INDEX;
+}
+
+
+/* Retourne la case qui suit le dernier caractère qui n'est pas un espace parmi
+count cases, sans dépasser la dernière */
+static uint8_t end_of_text(uint8_t first, uint8_t count){
+
+	uint8_t end;
+	uint8_t code;
+	uint8_t i;
+
+	end = first;
+
+	for(i = 0; i < count; i++){
+
+		read_cells(first + i, &code, 1);
+
+		if(code != BLANK_CHAR){
+
+			end = first + i + 1;
+		}
+	}
+
+	if(end > first + count - 1){
+
+		end = first + count - 1;
+	}
+
+	return end;
 }
 
 #endif
@@ -25,9 +25,10 @@
 	\author Iouri Savard Colbert
 	\date 28 avril 2014
 
-	Ce module est divisé en deux sous-modules suivants :
+	Ce module est divisé en trois sous-modules suivants :
     - hd44780
     - lcd
+    - text
 
 
     hd44780 :
@@ -52,6 +53,16 @@
 	sous-module et non pas par le pilote de hd44780.
 
 
+    text :
+
+    Un petit éditeur de texte qui utilise l'écran au complet. Le texte peut être
+	modifié n'importe où : les caractères sont insérés et effacés à la position du
+	curseur et la suite du texte se déplace en conséquence. Un '\n' envoie la
+	suite au début de la rangée suivante. Seules les cases qui changent
+	réellement sont réécrites. Le sous-module n'existe que si la switch
+	LCD_ENABLE_TEXT_MODULE est définie.
+
+
     Utilisation des sous modules :
 
     De façon à fonctionner correctement, les fonctions des sous modules ne
@@ -64,9 +75,89 @@
 /**
     \brief Switch qui permet l'utilisation de caractères japonais
 
-    Si la switch est définie, les caractères peuvent être utilisés
+    Si la switch est définie, les bytes de 0x80 à 0xFF sont envoyés tels quels et
+	affichent les katakanas et les symboles de la ROM du HD44780. Sinon, ils sont
+	pris comme du Latin-1 et lcd_write_string() décode l'UTF-8, ce qui permet
+	d'afficher directement du texte en français. Les symboles de la ROM restent
+	accessibles avec lcd_write_code().
 */
-#define ENABLE_JAPANESE_CHAR
+//#define ENABLE_JAPANESE_CHAR
+
+/**
+    \brief Switch qui active le framebuffer du sous-module lcd
+
+    Si la switch est définie, les fonctions lcd_write_char(), lcd_write_string(),
+	lcd_clear_display() et les déplacements du curseur ne touchent qu'une copie de
+	l'écran en RAM. C'est lcd_refresh() qui envoie au LCD seulement les cases qui ont
+	changé depuis le dernier appel. Effacer et réécrire tout l'écran à chaque
+	boucle ne coûte alors presque rien et ne fait plus clignoter l'affichage.
+
+	Le framebuffer coûte LCD_NB_ROW * LCD_NB_COL bytes de RAM, plus un bit par case.
+*/
+//#define LCD_ENABLE_FRAMEBUFFER
+
+/**
+    \brief Switch qui rend les envois au HD44780 asynchrones
+
+    Si la switch est définie, les commandes et les caractères sont placés dans une
+	file de LCD_QUEUE_SIZE / 2 éléments et les fonctions retournent tout de suite.
+	C'est une interruption du timer 2 (compare match), à toutes les LCD_TICK_US, qui
+	vide la file dès que le busy flag du HD44780 tombe. Un lcd_clear_display() ne
+	bloque donc plus le programme pendant 1.5 ms.
+
+	Le timer 2 est alors réservé au LCD et ne peut plus servir au PWM B. Les
+	interruptions doivent être activées avec sei(). Si elles ne le sont pas, la file
+	est vidée directement par la fonction qui manque de place.
+
+	L'initialisation est faite de la même façon : lcd_init() retourne en quelques
+	microsecondes et c'est l'interruption qui compte les 20 ms de délais de la
+	datasheet avant de commencer à vider la file. Ce qui est écrit d'ici là
+	attend dans la file. Le reste du programme (UART, ADC, etc.) peut donc être
+	initialisé pendant ce temps. Si la file déborde avant la fin, la fonction qui
+	manque de place attend comme avant.
+
+	lcd_idle() indique quand tout a été envoyé.
+*/
+//#define LCD_ENABLE_ASYNC
+
+/**
+    \brief Switch qui permet de brancher plusieurs LCD sur le même bus
+
+    Les LCD partagent le bus de données, RS et RW. Chacun a sa propre broche
+	enable sur CTRL_PORT, donnée par son lcd_display_t. lcd_select() choisit le
+	LCD auquel s'adressent toutes les autres fonctions. Tous les LCD ont la
+	géométrie choisie plus bas.
+
+	Ne peut pas être combinée avec LCD_ENABLE_FRAMEBUFFER, LCD_ENABLE_ASYNC ou
+	LCD_ENABLE_TEXT_MODULE, qui gardent l'état d'un seul écran.
+*/
+//#define LCD_ENABLE_MULTIPLE_DISPLAYS
+
+/**
+    \brief Switch qui active le sous-module text
+
+    Le texte est gardé dans un gap buffer de TEXT_BUFFER_SIZE bytes en RAM.
+*/
+//#define LCD_ENABLE_TEXT_MODULE
+
+/**
+    \brief Switch qui fait travailler le sous-module text sans copie en RAM
+
+    Si la switch est définie (avec LCD_ENABLE_TEXT_MODULE), il n'y a pas de gap
+	buffer : le texte est ce qui est affiché. Pour insérer ou effacer, la suite
+	de la rangée est relue dans la DDRAM du HD44780 (avec RW) et réécrite une case
+	plus loin. Les espaces à la fin de la rangée absorbent une insertion ; seule
+	une rangée pleine déborde sur la suivante. Ça économise TEXT_BUFFER_SIZE bytes
+	de RAM contre environ 50 us de bus par case déplacée. Seule une rangée est
+	gardée sur la pile, le temps d'un déplacement.
+
+	Comme rien ne distingue un espace d'un saut de ligne à l'écran, un '\n'
+	insère des espaces jusqu'à la fin de la rangée et le curseur peut aller sur
+	n'importe quelle case. LCD_SHIFT_END et LCD_SHIFT_BOTTOM vont après le dernier
+	caractère qui n'est pas un espace. Ne peut pas être combinée avec
+	LCD_ENABLE_FRAMEBUFFER.
+*/
+//#define LCD_TEXT_READ_BACK
 
 /* ----------------------------------------------------------------------------
 Includes
@@ -85,9 +176,25 @@ Defines et typedef
 #define DATA_PORT   PORTC
 
 /**
+    \brief Grosseur de la file en mode asynchrone. Chaque envoi prend deux bytes.
+*/
+#define LCD_QUEUE_SIZE 64
+
+/**
+    \brief Période de l'interruption qui vide la file en mode asynchrone, en us.
+	Une écriture prend environ 40 us au HD44780.
+*/
+#define LCD_TICK_US 40
+
+/**
     \brief Défini le registre pour contrôller la direction du data du LCD
 */
 #define DATA_DDR    DDRC
+
+/**
+    \brief Défini le registre pour lire le data du LCD (busy flag et relecture)
+*/
+#define DATA_PIN    PINC
 
 /**
     \brief Défini quel port est utilisé pour le contrôlle du LCD
@@ -100,7 +207,8 @@ Defines et typedef
 #define CTRL_DDR    DDRA
 
 /**
-    \brief Défini le numéro de la broche qui joue le rôle de enable
+    \brief Défini le numéro de la broche qui joue le rôle de enable. Avec
+	LCD_ENABLE_MULTIPLE_DISPLAYS, c'est celle de chaque lcd_display_t qui compte.
 */
 #define E_PIN       7
 
@@ -116,6 +224,30 @@ Defines et typedef
 
 
 /**
+    \brief Géométrie du LCD. Une seule de ces switches doit être définie.
+
+	Sur un LCD de 4 rangées, les rangées 2 et 3 sont la suite des rangées 0 et 1
+	dans la DDRAM du HD44780. L'adresse de chaque rangée est calculée à la
+	compilation à partir de LCD_NB_COL, aucune vérification n'est faite pendant
+	l'exécution.
+*/
+#define LCD_16X2
+//#define LCD_20X4
+//#define LCD_40X2
+
+#if defined(LCD_20X4)
+
+#define LCD_NB_COL 20
+#define LCD_NB_ROW 4
+
+#elif defined(LCD_40X2)
+
+#define LCD_NB_COL 40
+#define LCD_NB_ROW 2
+
+#else
+
+/**
     \brief Défini le bombre de colonnes du LCD
 */
 #define LCD_NB_COL 16
@@ -125,8 +257,18 @@ Defines et typedef
 */
 #define LCD_NB_ROW 2
 
+#endif
+
+/**
+    \brief Grosseur du texte du sous-module text. Chaque '\n' saute au moins
+	une case, alors le texte ne peut pas dépasser une case par caractère plus
+	un '\n' par rangée.
+*/
+#define TEXT_BUFFER_SIZE (LCD_NB_ROW * LCD_NB_COL + LCD_NB_ROW)
+
 /**
     \sa hd44780_shift_cursor(hd44780_shift_e shift)
+    \sa hd44780_shift_display(hd44780_shift_e shift)
 */
 typedef enum{
 
@@ -162,6 +304,59 @@ typedef enum{
     \sa lcd_write_char(char character)
 */
 #define CHAR_LEFT_ARROW 0x7F
+
+/**
+    \brief Nombre de caractères définissables en CGRAM. Les codes 0 à 7 les affichent.
+    \sa hd44780_write_cgram(uint8_t slot, const uint8_t* bitmap)
+*/
+#define HD44780_NB_CGRAM_CHAR 8
+
+/**
+    \brief Nombre de rangées de pixels d'un caractère défini en CGRAM
+*/
+#define HD44780_CGRAM_HEIGHT 8
+
+/**
+    \brief Nombre de caractères d'une rangée en DDRAM, affichés ou non
+    \sa hd44780_shift_display(hd44780_shift_e shift)
+*/
+#define HD44780_LINE_SIZE 40
+
+/**
+    \brief Un LCD branché sur le bus, avec LCD_ENABLE_MULTIPLE_DISPLAYS
+
+	Les champs autres que e_pin sont l'état du LCD pendant qu'il n'est pas
+	sélectionné. Ils appartiennent au module et sont initialisés par lcd_init().
+
+	\code
+
+	static lcd_display_t panel_a = LCD_DISPLAY(7);
+	static lcd_display_t panel_b = LCD_DISPLAY(4);
+
+	lcd_select(&panel_a);
+	lcd_init();
+	lcd_select(&panel_b);
+	lcd_init();
+
+	lcd_write_string("Panneau B");
+
+	\endcode
+*/
+typedef struct{
+
+	uint8_t e_pin;
+	uint8_t local_index;
+	bool clear_required_flag;
+	uint8_t transaction_depth;
+	uint8_t address_counter;
+	bool increment_mode;
+
+}lcd_display_t;
+
+/**
+    \brief Initialise un lcd_display_t dont la broche enable est e_pin, sur CTRL_PORT
+*/
+#define LCD_DISPLAY(e_pin) {(e_pin), 0, FALSE, 0, 0, TRUE}
 
 
 
@@ -209,14 +404,17 @@ void hd44780_set_display_control(bool display, bool cursor, bool blink);
 
 /**
     \brief Permet de déplacer le curseur dans la mémoire du HD44780.
-    \param[in]  col La colone de 0 à 39
-    \param[in]  row La rangé de 0 à 1
+    \param[in]  col La colone de 0 à 39 (de 0 à LCD_NB_COL - 1 sur un LCD de 4 rangées)
+    \param[in]  row La rangé de 0 à LCD_NB_ROW - 1
     \return Rien
 
     Cette fonction permet de faire abstraction des adresses en mémoire qui sont
     un peu batardes et d'y aller directement une position dans l'affichage.
     Rien n'empêche d'aller mettre un caractère à l'extérieur de la zone
     affichable, en autant que les limites des paramètres soient respectées
+
+	Le module garde une copie du compteur d'adresse du HD44780. Si le curseur est
+	déjà à cette position, rien n'est envoyé.
 */
 void hd44780_set_cursor_position(uint8_t col, uint8_t row);
 
@@ -227,6 +425,26 @@ void hd44780_set_cursor_position(uint8_t col, uint8_t row);
 */
 void hd44780_shift_cursor(hd44780_shift_e shift);
 
+/**
+    \brief Déplace tout l'affichage d'une case à gauche ou à droite
+    \param[in]  shift   La direction dans laquelle se déplace le texte
+
+	Les rangées font HD44780_LINE_SIZE caractères en DDRAM, dont seulement
+	LCD_NB_COL sont visibles. Décaler l'affichage montre les autres sans rien
+	réécrire, pour le coût d'une seule commande. Toutes les rangées se déplacent
+	ensemble et le texte fait le tour au bout des HD44780_LINE_SIZE caractères.
+	Le curseur ne bouge pas dans la DDRAM.
+*/
+void hd44780_shift_display(hd44780_shift_e shift);
+
+/**
+    \brief Ramène le curseur au début et annule le décalage de l'affichage
+
+	Le contenu de la DDRAM n'est pas modifié. Comme hd44780_clear_display(),
+	la commande prend 1.52 ms.
+*/
+void hd44780_return_home(void);
+
 /**
     \brief Écrit un seul caractère à l'endroit actuel du curseur.
     \param[in]  character   Le caractère ASCII à afficher.
@@ -234,10 +452,62 @@ void hd44780_shift_cursor(hd44780_shift_e shift);
 
     Au retour, le curseur aura été déplacé d'une position dans le sens déterminé à l'aide
     de hd44780_set_entry_mode.  Si le caractère n'est pas affichable, une boule
-    pas rapport sera affiché à la place.
+    pas rapport sera affiché à la place. Les codes 0 à HD44780_NB_CGRAM_CHAR - 1
+    affichent les caractères définis avec hd44780_write_cgram().
 */
 void hd44780_write_char(char character);
 
+/**
+    \brief Écrit un code de la ROM (ou de la CGRAM) tel quel, à l'endroit actuel
+	du curseur
+    \param[in]  code    Le code, tel que dans la table de caractères de la
+	datasheet du HD44780
+
+	Contrairement à hd44780_write_char(), le code ne passe pas par la conversion
+	Latin-1. Sert aux symboles de la ROM qui n'ont pas d'équivalent Latin-1, comme
+	le bloc plein 0xFF.
+*/
+void hd44780_write_code(uint8_t code);
+
+/**
+    \brief Lit le caractère sous le curseur dans la DDRAM
+    \return Le code de la ROM du HD44780 (pas le caractère Latin-1 écrit)
+
+	Le curseur avance comme après une écriture. La commande d'adresse que la
+	datasheet exige entre une écriture et une lecture est envoyée au besoin.
+*/
+uint8_t hd44780_read_data(void);
+
+/**
+    \brief Lit le busy flag du HD44780
+    \return TRUE si le HD44780 exécute encore la dernière commande
+
+	Toutes les fonctions hd44780_* attendent d'elles-mêmes que le busy flag tombe
+	avant d'envoyer quoi que ce soit. Cette fonction sert seulement à savoir, sans
+	bloquer, si un envoi va devoir attendre.
+*/
+bool hd44780_is_busy(void);
+
+/**
+    \brief Lit le compteur d'adresse (la position du curseur) du HD44780
+    \return L'adresse en DDRAM (ou en CGRAM si la dernière commande d'adresse était
+	une adresse de CGRAM). Sur la rangée 1, les adresses commencent à 0x40.
+
+	La fonction attend que le HD44780 ait terminé la dernière commande.
+*/
+uint8_t hd44780_get_address(void);
+
+/**
+    \brief Défini un caractère en CGRAM
+    \param[in]  slot    Le numéro du caractère, de 0 à HD44780_NB_CGRAM_CHAR - 1
+    \param[in]  bitmap  HD44780_CGRAM_HEIGHT rangées de pixels, de haut en bas. Les 5
+	bits de poids faible de chaque rangée sont les pixels, le bit 4 à gauche.
+
+	La position du curseur est conservée. Les cases qui affichent déjà ce caractère
+	changent immédiatement.
+*/
+void hd44780_write_cgram(uint8_t slot, const uint8_t* bitmap);
+
 
 
 /* LCD --------------------------------------------------------------------- */
@@ -251,6 +521,24 @@ void hd44780_write_char(char character);
 */
 void lcd_init(void);
 
+#ifdef LCD_ENABLE_MULTIPLE_DISPLAYS
+
+/**
+    \brief Choisit le LCD auquel s'adressent les fonctions hd44780_* et lcd_*
+    \param[in]  display Le LCD. Il doit rester en mémoire tant qu'il sert.
+
+	L'état du LCD précédent (position du curseur, transaction, etc.) est rangé
+	dans son lcd_display_t et celui du nouveau est repris du sien. Changer de
+	LCD ne coûte donc aucun envoi. lcd_init() doit être appelée une fois pour
+	chaque LCD, après l'avoir sélectionné.
+
+	Les modules qui gardent leur propre copie de l'écran (glyph, console,
+	lcd_field, etc.) ne suivent qu'un seul LCD.
+*/
+void lcd_select(lcd_display_t* display);
+
+#endif
+
 /**
     \brief Efface l'écran du LCD et retourne le curseur à la position 0,0
 	Il n'est pas réelement possible "d'effacer" l'écran du LCD. Bien que
@@ -328,10 +616,14 @@ void lcd_shift_cursor(lcd_shift_e shift);
     \brief Écrit un seul caractère ASCII à la position du curseur sur le LCD
     \param[in]  character Le caractère à afficher
 
-	Le LCD ne gère pas les accents et les caractères un peu spéciaux. L'exception
-	à la règle sont deux flèches. C'est deux caractères ne font pas parti du code
-	ASCII. Pour les afficher, il est possible d'appeler la fonction avec l'une des
-	deux définitions suivantes :
+	Le caractère est en Latin-1. Le LCD ne gère pas les accents : les lettres
+	accentuées sont affichées sans leur accent, sauf ä, ö, ü et ñ qui sont dans la
+	ROM. Les caractères qui n'ont pas d'équivalent sont remplacés par une boule.
+	Les bytes de 0x80 à 0xFF sont donc du Latin-1 et non des codes de la ROM :
+	0xFF affiche un 'y' (ÿ), pas le bloc plein. Les symboles de la ROM
+	s'écrivent avec lcd_write_code().
+	Deux flèches ne font pas parti du code ASCII. Pour les afficher, il est
+	possible d'appeler la fonction avec l'une des deux définitions suivantes :
 
     - CHAR_RIGHT_ARROW
     - CHAR_LEFT_ARROW
@@ -342,6 +634,18 @@ void lcd_shift_cursor(lcd_shift_e shift);
 */
 void lcd_write_char(char character);
 
+/**
+    \brief Écrit un code de la ROM (ou de la CGRAM) tel quel, à la position du
+	curseur sur le LCD
+    \param[in]  code    Le code, tel que dans la table de caractères de la
+	datasheet du HD44780
+
+	Comme lcd_write_char(), mais sans conversion Latin-1 ni caractère de contrôle.
+	C'est la façon d'afficher les symboles de la ROM de 0x80 à 0xFF (le bloc
+	plein 0xFF, par exemple) quand ENABLE_JAPANESE_CHAR n'est pas définie.
+*/
+void lcd_write_code(uint8_t code);
+
 /**
     \brief Écrit une string à la position du curseur sur le LCD.
     \param[in] string La string à afficher
@@ -350,6 +654,11 @@ void lcd_write_char(char character);
 	que la string soit terminée par un caractère nul ('\0'). Le caractère nul
 	n'est pas envoyé au LCD.
 
+	La string est décodée en UTF-8, comme les littéraux d'un fichier source
+	enregistré en UTF-8 : `lcd_write_string("Été");` affiche "Ete". Un byte qui
+	n'est pas de l'UTF-8 valide est affiché comme du Latin-1. Si la switch
+	ENABLE_JAPANESE_CHAR est définie, la string n'est pas décodée.
+
 	Par exemple :
 
 	`lcd_write_string("Hello World");` produira le résultat suivant :
@@ -430,5 +739,140 @@ void lcd_write_char(char character);
 */
 void lcd_write_string(const char* string);
 
+/**
+    \brief Envoie au LCD les cases du framebuffer qui ont changé
+
+	Les cases qui se suivent sur une même ligne sont envoyées d'un seul coup
+	puisque le HD44780 avance son curseur tout seul. Une seule commande de
+	positionnement est donc nécessaire par groupe de cases modifiées. Le curseur
+	est ensuite replacé à sa position logique.
+
+	Si LCD_ENABLE_FRAMEBUFFER n'est pas définie, l'écran est toujours à jour et
+	cette fonction ne fait rien. Un programme qui l'appelle fonctionne donc dans
+	les deux cas.
+*/
+void lcd_refresh(void);
+
+/**
+    \brief Indique si tout ce qui a été demandé au LCD lui a été envoyé
+	\return FALSE si la file du mode asynchrone n'est pas encore vide
+
+	Si LCD_ENABLE_ASYNC n'est pas définie, les envois sont faits immédiatement et
+	la fonction retourne toujours TRUE.
+*/
+bool lcd_idle(void);
+
+/**
+    \brief Commence une transaction
+
+	Entre lcd_begin() et lcd_end(), les déplacements du curseur ne sont pas envoyés
+	au HD44780. Ils le sont seulement au prochain caractère, et seulement si le
+	HD44780 n'est pas déjà au bon endroit. Positionner puis écrire plusieurs
+	champs ne coûte donc qu'une commande d'adresse par champ, et aucune si le
+	champ suit le précédent.
+
+	Les transactions peuvent s'imbriquer; seul le dernier lcd_end() compte.
+	lcd_write_string() en fait une d'elle-même. Le curseur affiché ne suit pas
+	pendant la transaction. Avec LCD_ENABLE_FRAMEBUFFER, lcd_refresh() fait déjà
+	ce travail et ces deux fonctions ne font rien.
+
+	\code
+
+	lcd_begin();
+
+	lcd_set_cursor_position(0, 0);
+	lcd_write_string("T: ");
+	lcd_write_string(temperature);
+	lcd_set_cursor_position(0, 1);
+	lcd_write_string(pressure);
+
+	lcd_end();
+
+	\endcode
+*/
+void lcd_begin(void);
+
+/**
+    \brief Termine une transaction et replace le curseur à sa position logique
+*/
+void lcd_end(void);
+
+
+
+/* Text -------------------------------------------------------------------- */
+
+#ifdef LCD_ENABLE_TEXT_MODULE
+
+/**
+    \brief Fait l'initialisation du LCD et vide le texte
+
+	Remplace lcd_init() pour un programme qui utilise le sous-module text.
+*/
+void text_init(void);
+
+/**
+    \brief Efface l'écran et vide le texte
+*/
+void text_clear_display(void);
+
+/**
+    \brief Place le curseur sur le caractère affiché à une position
+    \param[in]  col La colonne
+    \param[in]  row La rangée
+
+	Si aucun caractère n'est affiché à cette case (après la fin d'une ligne, par
+	exemple), le curseur est placé sur le dernier caractère qui la précède.
+*/
+void text_set_cursor_position(uint8_t col, uint8_t row);
+
+/**
+    \brief Déplace le curseur dans le texte
+    \param[in]  shift   La direction
+
+	LCD_SHIFT_RIGHT et LCD_SHIFT_LEFT avancent et reculent d'un caractère,
+	LCD_SHIFT_UP et LCD_SHIFT_DOWN changent de rangée en gardant la colonne si
+	possible, LCD_SHIFT_START et LCD_SHIFT_END vont au début et à la fin de la
+	rangée, LCD_SHIFT_TOP et LCD_SHIFT_BOTTOM vont au début et à la fin du texte.
+	Le curseur ne fait jamais le tour de l'écran.
+*/
+void text_shift_cursor(lcd_shift_e shift);
+
+/**
+    \brief Insère un caractère à la position du curseur
+    \param[in]  character   Le caractère. '\n' insère un saut de ligne.
+	\return FALSE si le texte ne tiendrait plus à l'écran, rien n'est alors inséré
+
+	Seules les cases entre le curseur et la fin de la ligne sont réécrites, sauf
+	si la ligne déborde sur la rangée suivante.
+*/
+bool text_write_char(char character);
+
+/**
+    \brief Insère un saut de ligne à la position du curseur
+	\return FALSE si le texte ne tiendrait plus à l'écran
+*/
+bool text_line_break(void);
+
+/**
+    \brief Efface le caractère avant le curseur (backspace)
+*/
+void text_del_last_char(void);
+
+/**
+    \brief Efface le caractère sous le curseur (delete)
+*/
+void text_del_current_char(void);
+
+/**
+    \brief Insère une string à la position du curseur
+    \param[in]  string  La string
+	\return FALSE si la string a été tronquée pour que le texte tienne à l'écran
+
+	L'écran n'est réécrit qu'une fois pour toute la string.
+*/
+bool text_write_string(const char* string);
+
+#endif
+
 
 #endif // LCD_H_INCLUDED
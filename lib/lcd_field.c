@@ -0,0 +1,234 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file lcd_field.c
+	\brief Champs numériques sur le LCD qui ne réécrivent que ce qui change
+	\author Iouri Savard Colbert
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <avr/pgmspace.h>
+
+#include "lcd_field.h"
+#include "lcd.h"
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+/* Ne correspond à aucun caractère affichable, force la réécriture */
+#define UNKNOWN_CHAR '\0'
+
+/* Assez pour un uint32_t : 10 chiffres */
+#define MAX_DIGITS 10
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+static const lcd_field_t* field_table;
+static uint8_t field_count;
+
+/* Ce qui est affiché dans chaque champ */
+static char shown[LCD_FIELD_MAX_FIELDS][LCD_FIELD_MAX_WIDTH];
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static void format(const lcd_field_t* field, int32_t value, char* text);
+
+
+/******************************************************************************
+Global functions
+******************************************************************************/
+
+bool lcd_field_init(const lcd_field_t* fields, uint8_t count){
+
+	uint8_t i;
+
+	field_table = fields;
+	field_count = 0;
+
+	if(count > LCD_FIELD_MAX_FIELDS){
+
+		return FALSE;
+	}
+
+	for(i = 0; i < count; i++){
+
+		if(pgm_read_byte(&fields[i].width) > LCD_FIELD_MAX_WIDTH){
+
+			return FALSE;
+		}
+	}
+
+	field_count = count;
+
+	lcd_field_invalidate();
+
+	return TRUE;
+}
+
+
+void lcd_field_set(uint8_t id, int32_t value){
+
+	lcd_field_t field;
+	char text[LCD_FIELD_MAX_WIDTH];
+	uint8_t next = 0xFF;
+	uint8_t i;
+
+	if(id >= field_count){
+
+		return;
+	}
+
+	memcpy_P(&field, &field_table[id], sizeof(lcd_field_t));
+
+	format(&field, value, text);
+
+	for(i = 0; i < field.width; i++){
+
+		if(text[i] != shown[id][i]){
+
+			// Les caractères qui se suivent partagent le même positionnement
+			if(i != next){
+
+				lcd_set_cursor_position(field.col + i, field.row);
+			}
+
+			lcd_write_char(text[i]);
+
+			shown[id][i] = text[i];
+			next = i + 1;
+		}
+	}
+}
+
+
+void lcd_field_invalidate(void){
+
+	mem_set(shown, UNKNOWN_CHAR, sizeof(shown));
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* Écrit exactement field->width caractères dans text, sans '\0' */
+static void format(const lcd_field_t* field, int32_t value, char* text){
+
+	char digits[MAX_DIGITS + 1];
+	uint8_t first = 0;
+	uint8_t digit_count;
+	uint8_t length;
+	uint8_t padding;
+	uint8_t i = 0;
+	uint32_t magnitude;
+	bool negative = FALSE;
+
+	if(value < 0){
+
+		if(field->is_signed == TRUE){
+
+			negative = TRUE;
+			magnitude = -(uint32_t)value;
+		}
+
+		else{
+
+			magnitude = 0;
+		}
+	}
+
+	else{
+
+		magnitude = (uint32_t)value;
+	}
+
+	// Les zéros de gauche sont enlevés, sauf ceux qui viennent avant ou après le
+	// point : 5 avec 2 décimales donne "0.05".
+	uint32_to_string(digits, magnitude);
+
+	while((first < MAX_DIGITS - 1) && (digits[first] == '0') && (MAX_DIGITS - first > field->decimals + 1)){
+
+		first++;
+	}
+
+	digit_count = MAX_DIGITS - first;
+
+	length = digit_count + negative + ((field->decimals > 0) ? 1 : 0);
+
+	if(length > field->width){
+
+		for(i = 0; i < field->width; i++){
+
+			text[i] = LCD_FIELD_OVERFLOW_CHAR;
+		}
+
+		return;
+	}
+
+	padding = field->width - length;
+
+	if(field->align == LCD_FIELD_ALIGN_RIGHT){
+
+		while(i < padding){
+
+			text[i++] = ' ';
+		}
+	}
+
+	if(negative == TRUE){
+
+		text[i++] = '-';
+	}
+
+	if(field->align == LCD_FIELD_ALIGN_ZERO){
+
+		while(i < padding + negative){
+
+			text[i++] = '0';
+		}
+	}
+
+	while(digit_count > 0){
+
+		digit_count--;
+
+		text[i++] = digits[MAX_DIGITS - 1 - digit_count];
+
+		if((digit_count == field->decimals) && (digit_count > 0)){
+
+			text[i++] = '.';
+		}
+	}
+
+	while(i < field->width){
+
+		text[i++] = ' ';
+	}
+}
@@ -0,0 +1,149 @@
+#ifndef LCD_FIELD_H_INCLUDED
+#define LCD_FIELD_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file lcd_field.h
+	\brief Champs numériques sur le LCD qui ne réécrivent que ce qui change
+	\author Iouri Savard Colbert
+
+	Afficher une valeur avec uint16_to_string() puis lcd_write_string() envoie
+	tous les chiffres à chaque fois, même ceux qui n'ont pas changé. Ici, chaque
+	champ a une position, une largeur et un format fixes, décrits une fois pour
+	toutes dans une table en flash. lcd_field_set() formate la valeur et compare
+	le résultat à ce qui est déjà à l'écran : seuls les caractères différents
+	sont envoyés. Une valeur qui passe de 1234 à 1235 ne coûte qu'un caractère.
+
+	\code
+
+	enum{FIELD_VOLTAGE, FIELD_TEMPERATURE};
+
+	static const lcd_field_t fields[] PROGMEM = {
+
+		// col, row, width, decimals, align,                 is_signed
+		{  2,   0,   5,     2,        LCD_FIELD_ALIGN_RIGHT, FALSE},	// " 4.98"
+		{  10,  0,   5,     1,        LCD_FIELD_ALIGN_RIGHT, TRUE},	// "-12.5"
+	};
+
+	lcd_init();
+	lcd_write_string("V=      T=");
+	lcd_field_init(fields, 2);
+
+	while(1){
+
+		lcd_field_set(FIELD_VOLTAGE, millivolts / 10);
+		lcd_field_set(FIELD_TEMPERATURE, temperature_x10);
+	}
+
+	\endcode
+
+	Les fonctions déplacent le curseur du LCD. Après un lcd_clear_display(), il
+	faut appeler lcd_field_invalidate() pour que les champs soient réécrits au
+	complet.
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include "utils.h"
+
+
+/* ----------------------------------------------------------------------------
+Defines et typedef
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Nombre maximal de champs
+*/
+#define LCD_FIELD_MAX_FIELDS 8
+
+/**
+    \brief Largeur maximale d'un champ, en caractères
+*/
+#define LCD_FIELD_MAX_WIDTH 8
+
+/**
+    \brief Caractère qui remplit un champ trop petit pour sa valeur
+*/
+#define LCD_FIELD_OVERFLOW_CHAR '*'
+
+/**
+    \sa lcd_field_t
+*/
+typedef enum{
+
+	LCD_FIELD_ALIGN_RIGHT,      ///< "  -42", complété par des espaces à gauche
+	LCD_FIELD_ALIGN_LEFT,       ///< "-42  ", complété par des espaces à droite
+	LCD_FIELD_ALIGN_ZERO        ///< "-0042", complété par des zéros après le signe
+
+}lcd_field_align_e;
+
+/**
+    \brief La description d'un champ. Les tables de champs sont en flash.
+*/
+typedef struct{
+
+	uint8_t col;
+	uint8_t row;
+	uint8_t width;                  ///< De 1 à LCD_FIELD_MAX_WIDTH
+	uint8_t decimals;               ///< Nombre de chiffres après le point
+	lcd_field_align_e align;
+	bool is_signed;                 ///< Si FALSE, les valeurs négatives affichent 0
+
+}lcd_field_t;
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Enregistre une table de champs
+    \param[in]  fields  La table, en flash (PROGMEM)
+    \param[in]  count   Le nombre de champs, au plus LCD_FIELD_MAX_FIELDS
+	\return FALSE si la table a trop de champs ou un champ trop large
+
+	Le LCD doit avoir été initialisé avant. Rien n'est affiché avant le premier
+	lcd_field_set() de chaque champ.
+*/
+bool lcd_field_init(const lcd_field_t* fields, uint8_t count);
+
+/**
+    \brief Affiche une valeur dans un champ
+    \param[in]  id      Le numéro du champ dans la table
+    \param[in]  value   La valeur, en unités de la dernière décimale. Avec 2
+	décimales, 1234 s'affiche "12.34".
+
+	Seuls les caractères qui diffèrent de ceux déjà affichés sont envoyés. Si la
+	valeur ne tient pas dans la largeur du champ, il est rempli de
+	LCD_FIELD_OVERFLOW_CHAR.
+*/
+void lcd_field_set(uint8_t id, int32_t value);
+
+/**
+    \brief Oublie ce qui est affiché dans les champs
+
+	Le prochain lcd_field_set() de chaque champ le réécrira au complet.
+*/
+void lcd_field_invalidate(void);
+
+
+#endif // LCD_FIELD_H_INCLUDED
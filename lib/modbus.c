@@ -0,0 +1,466 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file modbus.c
+	\brief Esclave Modbus RTU bâti par dessus le module uart
+	\author Iouri Savard Colbert
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#include "modbus.h"
+#include "crc.h"
+#include "reg.h"
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+#define FUNCTION_READ_HOLDING_REGISTERS		0x03
+#define FUNCTION_READ_INPUT_REGISTERS		0x04
+#define FUNCTION_WRITE_SINGLE_REGISTER		0x06
+#define FUNCTION_WRITE_MULTIPLE_REGISTERS	0x10
+
+#define EXCEPTION_FLAG						0x80
+#define EXCEPTION_ILLEGAL_FUNCTION			0x01
+#define EXCEPTION_ILLEGAL_DATA_ADDRESS		0x02
+#define EXCEPTION_ILLEGAL_DATA_VALUE		0x03
+
+/* Adresse + fonction + nombre de bytes + CRC */
+#define MAX_READ_COUNT		((MODBUS_FRAME_SIZE - 5) / 2)
+
+/* Adresse + fonction + adresse + quantité + nombre de bytes + CRC */
+#define MAX_WRITE_COUNT		((MODBUS_FRAME_SIZE - 9) / 2)
+
+/* Une requête de lecture ou d'écriture simple fait toujours 8 bytes avec le CRC */
+#define SHORT_REQUEST_LENGTH	8
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+/* Durée de 3.5 caractères de 11 bits pour chaque baudrate_e. Au-delà de 19200 bauds
+la norme fixe cette durée à 1750 us. */
+static const uint16_t silence_us[] = {
+
+	16042,	/* BAUDRATE_2400 */
+	8021,	/* BAUDRATE_4800 */
+	4010,	/* BAUDRATE_9600 */
+	1750,	/* BAUDRATE_19200 */
+	1750,	/* BAUDRATE_38400 */
+	1750,	/* BAUDRATE_57600 */
+	1750,	/* BAUDRATE_115200 */
+	1750,	/* BAUDRATE_230400 */
+	1750,	/* BAUDRATE_250000 */
+};
+
+static uint8_t frame[MODBUS_FRAME_SIZE];
+static volatile uint8_t frame_length;
+static volatile uint16_t frame_crc;
+static volatile bool frame_overflow;
+static volatile bool frame_ready;
+
+static uint8_t local_address;
+
+static const modbus_register_t* holding_table;
+static uint8_t holding_table_count;
+static const modbus_register_t* input_table;
+static uint8_t input_table_count;
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static void receive_byte(uint8_t byte);
+static void reset_frame(void);
+
+static uint16_t read_uint16(const uint8_t* ptr);
+static void write_uint16(uint8_t* ptr, uint16_t value);
+
+static uint8_t read_registers(const modbus_register_t* table, uint8_t count);
+static uint8_t write_single_register(void);
+static uint8_t write_multiple_registers(void);
+static uint8_t exception(uint8_t code);
+
+static void send_frame(uint8_t length);
+
+
+/******************************************************************************
+Interupts
+******************************************************************************/
+
+/**
+    \brief Le silence de 3.5 caractères est écoulé : la trame est terminée
+*/
+ISR(TIMER0_COMP_vect){
+
+	reg_clear_bit(TIMSK, OCIE0);
+
+	/* Un CRC calculé sur la trame au complet, incluant son propre CRC, donne 0.
+	Les trames corrompues ou qui ne nous sont pas adressées sont jetées tout de
+	suite pour ne pas manquer le début de la prochaine. */
+	if((frame_length < 4) ||
+	   (frame_overflow == TRUE) ||
+	   (frame_crc != 0) ||
+	   ((frame[0] != local_address) && (frame[0] != MODBUS_BROADCAST_ADDRESS))){
+
+		reset_frame();
+	}
+
+	else{
+
+		frame_ready = TRUE;
+	}
+}
+
+
+/******************************************************************************
+Global functions
+******************************************************************************/
+
+void modbus_init(uint8_t slave_address, baudrate_e baudrate,
+				 const modbus_register_t* holding_registers, uint8_t holding_count,
+				 const modbus_register_t* input_registers, uint8_t input_count){
+
+	uint32_t ticks;
+	uint8_t clock_select;
+
+	local_address = slave_address;
+
+	holding_table = holding_registers;
+	holding_table_count = holding_count;
+	input_table = input_registers;
+	input_table_count = input_count;
+
+	reset_frame();
+
+	/* On cherche le plus petit prescaler (8, 64, 256 puis 1024) qui permet de
+	compter le silence sur 8 bits */
+	ticks = ((uint32_t)silence_us[baudrate] * (F_CPU / 1000000UL)) / 8;
+	clock_select = 2;
+
+	while((ticks > 256) && (clock_select < 5)){
+
+		/* De 8 à 64 c'est fois 8, ensuite c'est fois 4 */
+		if(clock_select == 2){
+
+			ticks /= 8;
+		}
+
+		else{
+
+			ticks /= 4;
+		}
+
+		clock_select++;
+	}
+
+	/* À très haute fréquence et très bas baudrate, on se contente de ce qu'on peut
+	compter. C'est quand même beaucoup plus que 1.5 caractère. */
+	if(ticks > 256){
+
+		ticks = 256;
+	}
+
+	/* Timer 0 en mode CTC */
+	TCCR0 = (1 << WGM01) | clock_select;
+	OCR0 = (uint8_t)(ticks - 1);
+	TCNT0 = 0;
+
+	uart_set_baudrate(baudrate);
+	uart_set_tx_policy(UART_POLICY_BLOCK);
+	uart_set_rx_handler(receive_byte);
+}
+
+
+bool modbus_poll(void){
+
+	uint8_t response_length = 0;
+
+	if(frame_ready == FALSE){
+
+		return FALSE;
+	}
+
+	switch(frame[1]){
+	case FUNCTION_READ_HOLDING_REGISTERS:
+
+		response_length = read_registers(holding_table, holding_table_count);
+		break;
+
+	case FUNCTION_READ_INPUT_REGISTERS:
+
+		response_length = read_registers(input_table, input_table_count);
+		break;
+
+	case FUNCTION_WRITE_SINGLE_REGISTER:
+
+		response_length = write_single_register();
+		break;
+
+	case FUNCTION_WRITE_MULTIPLE_REGISTERS:
+
+		response_length = write_multiple_registers();
+		break;
+
+	default:
+
+		response_length = exception(EXCEPTION_ILLEGAL_FUNCTION);
+		break;
+	}
+
+	/* On ne répond jamais à un broadcast */
+	if(frame[0] != MODBUS_BROADCAST_ADDRESS){
+
+		send_frame(response_length);
+	}
+
+	/* Le buffer est libéré seulement maintenant puisque la réponse y était */
+	reset_frame();
+
+	return TRUE;
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* Appelée par le ISR de réception du uart pour chaque byte */
+static void receive_byte(uint8_t byte){
+
+	/* Tant que la trame précédente n'est pas traitée, on ignore tout */
+	if(frame_ready == FALSE){
+
+		if(frame_length < MODBUS_FRAME_SIZE){
+
+			frame[frame_length] = byte;
+			frame_length++;
+
+			frame_crc = crc16_modbus_update(frame_crc, byte);
+		}
+
+		else{
+
+			frame_overflow = TRUE;
+		}
+
+		/* On repart le chronomètre du silence */
+		TCNT0 = 0;
+		TIFR = (1 << OCF0);		// Le flag s'efface en y écrivant un 1
+		reg_set_bit(TIMSK, OCIE0);
+	}
+}
+
+
+static void reset_frame(void){
+
+	frame_length = 0;
+	frame_crc = CRC16_MODBUS_INIT;
+	frame_overflow = FALSE;
+	frame_ready = FALSE;
+}
+
+
+/* Modbus est big endian */
+static uint16_t read_uint16(const uint8_t* ptr){
+
+	return ((uint16_t)ptr[0] << 8) | ptr[1];
+}
+
+
+static void write_uint16(uint8_t* ptr, uint16_t value){
+
+	ptr[0] = (uint8_t)(value >> 8);
+	ptr[1] = (uint8_t)(value & 0xFF);
+}
+
+
+/*
+	Requête :	adresse, fonction, premier registre (2), quantité (2), CRC (2)
+	Réponse :	adresse, fonction, nombre de bytes, valeurs (2 * quantité), CRC (2)
+
+	La réponse écrase la requête à partir du troisième byte, c'est pourquoi les
+	paramètres sont lus avant.
+*/
+static uint8_t read_registers(const modbus_register_t* table, uint8_t count){
+
+	uint16_t start;
+	uint16_t quantity;
+	uint16_t (*read)(uint8_t arg);
+	uint8_t i;
+
+	if(frame_length != SHORT_REQUEST_LENGTH){
+
+		return exception(EXCEPTION_ILLEGAL_DATA_VALUE);
+	}
+
+	start = read_uint16(&frame[2]);
+	quantity = read_uint16(&frame[4]);
+
+	if((quantity == 0) || (quantity > MAX_READ_COUNT)){
+
+		return exception(EXCEPTION_ILLEGAL_DATA_VALUE);
+	}
+
+	/* start + quantity déborderait sur 16 bits avec start près de 0xFFFF */
+	if((start >= count) || (quantity > count - start)){
+
+		return exception(EXCEPTION_ILLEGAL_DATA_ADDRESS);
+	}
+
+	/* On valide tout avant de répondre quoi que ce soit */
+	for(i = 0; i < quantity; i++){
+
+		if(pgm_read_word(&table[start + i].read) == 0){
+
+			return exception(EXCEPTION_ILLEGAL_DATA_ADDRESS);
+		}
+	}
+
+	frame[2] = (uint8_t)(quantity * 2);
+
+	for(i = 0; i < quantity; i++){
+
+		read = (uint16_t (*)(uint8_t))pgm_read_word(&table[start + i].read);
+
+		write_uint16(&frame[3 + 2 * i], read(pgm_read_byte(&table[start + i].arg)));
+	}
+
+	return 3 + frame[2];
+}
+
+
+/*
+	Requête :	adresse, fonction, registre (2), valeur (2), CRC (2)
+	Réponse :	identique à la requête, donc il n'y a rien à construire
+*/
+static uint8_t write_single_register(void){
+
+	uint16_t address;
+	void (*write)(uint8_t arg, uint16_t value);
+
+	if(frame_length != SHORT_REQUEST_LENGTH){
+
+		return exception(EXCEPTION_ILLEGAL_DATA_VALUE);
+	}
+
+	address = read_uint16(&frame[2]);
+
+	if(address >= holding_table_count){
+
+		return exception(EXCEPTION_ILLEGAL_DATA_ADDRESS);
+	}
+
+	write = (void (*)(uint8_t, uint16_t))pgm_read_word(&holding_table[address].write);
+
+	if(write == NULL){
+
+		return exception(EXCEPTION_ILLEGAL_DATA_ADDRESS);
+	}
+
+	write(pgm_read_byte(&holding_table[address].arg), read_uint16(&frame[4]));
+
+	return 6;
+}
+
+
+/*
+	Requête :	adresse, fonction, premier registre (2), quantité (2), nombre de bytes,
+				valeurs (2 * quantité), CRC (2)
+	Réponse :	les 6 premiers bytes de la requête
+*/
+static uint8_t write_multiple_registers(void){
+
+	uint16_t start;
+	uint16_t quantity;
+	void (*write)(uint8_t arg, uint16_t value);
+	uint8_t i;
+
+	start = read_uint16(&frame[2]);
+	quantity = read_uint16(&frame[4]);
+
+	if((quantity == 0) ||
+	   (quantity > MAX_WRITE_COUNT) ||
+	   (frame[6] != quantity * 2) ||
+	   (frame_length != 9 + frame[6])){
+
+		return exception(EXCEPTION_ILLEGAL_DATA_VALUE);
+	}
+
+	if((start >= holding_table_count) || (quantity > holding_table_count - start)){
+
+		return exception(EXCEPTION_ILLEGAL_DATA_ADDRESS);
+	}
+
+	/* On valide tout avant d'écrire quoi que ce soit pour ne pas laisser une
+	écriture à moitié faite */
+	for(i = 0; i < quantity; i++){
+
+		if(pgm_read_word(&holding_table[start + i].write) == 0){
+
+			return exception(EXCEPTION_ILLEGAL_DATA_ADDRESS);
+		}
+	}
+
+	for(i = 0; i < quantity; i++){
+
+		write = (void (*)(uint8_t, uint16_t))pgm_read_word(&holding_table[start + i].write);
+
+		write(pgm_read_byte(&holding_table[start + i].arg), read_uint16(&frame[7 + 2 * i]));
+	}
+
+	return 6;
+}
+
+
+static uint8_t exception(uint8_t code){
+
+	frame[1] = set_bits(frame[1], EXCEPTION_FLAG);
+	frame[2] = code;
+
+	return 3;
+}
+
+
+static void send_frame(uint8_t length){
+
+	uint16_t crc = CRC16_MODBUS_INIT;
+	uint8_t i;
+
+	for(i = 0; i < length; i++){
+
+		uart_put_byte(frame[i]);
+
+		crc = crc16_modbus_update(crc, frame[i]);
+	}
+
+	/* Le CRC est le seul champ little endian de Modbus */
+	uart_put_byte((uint8_t)(crc & 0xFF));
+	uart_put_byte((uint8_t)(crc >> 8));
+}
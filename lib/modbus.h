@@ -0,0 +1,170 @@
+#ifndef MODBUS_H_INCLUDED
+#define MODBUS_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file modbus.h
+	\brief Esclave Modbus RTU bâti par dessus le module uart
+	\author Iouri Savard Colbert
+
+	Le module s'occupe de tout le protocole :
+
+	- La fin d'une trame est détectée par un silence de 3.5 caractères chronométré
+	avec le timer 0.
+	- Le CRC est calculé au fur et à mesure que les bytes arrivent, directement dans
+	l'interruption de réception. Quand le silence est détecté, la trame est déjà
+	validée.
+	- La trame est décodée sur place, dans le buffer de réception, et la réponse est
+	construite dans ce même buffer. Aucune donnée n'est copiée.
+
+	Les fonctions supportées sont :
+
+	- 0x03 Read Holding Registers
+	- 0x04 Read Input Registers
+	- 0x06 Write Single Register
+	- 0x10 Write Multiple Registers
+
+	Les registres sont décrits par deux tables en flash (PROGMEM); une pour les
+	input registers (lecture seulement) et une pour les holding registers. L'adresse
+	Modbus d'un registre est directement son index dans la table, il n'y a donc pas
+	de recherche à faire.
+
+	\code
+
+	static uint16_t read_adc(uint8_t channel){
+
+		return adc_read(channel);
+	}
+
+	static void write_servo(uint8_t servo, uint16_t angle){
+
+		if(servo == 0) servo_set_a(angle);
+		else servo_set_b(angle);
+	}
+
+	static const modbus_register_t input_registers[] PROGMEM = {
+
+		{read_adc, NULL, 0},		// 0 : ADC 0
+		{read_adc, NULL, 1},		// 1 : ADC 1
+	};
+
+	static const modbus_register_t holding_registers[] PROGMEM = {
+
+		{read_servo, write_servo, 0},	// 0 : Servo A
+		{read_servo, write_servo, 1},	// 1 : Servo B
+		{read_pwm, write_pwm, 0},		// 2 : PWM A
+	};
+
+	uart_init();
+	modbus_init(17, BAUDRATE_19200, holding_registers, 3, input_registers, 2);
+	sei();
+
+	while(1){
+
+		modbus_poll();
+	}
+
+	\endcode
+
+	\warning Le module prend le contrôle du timer 0. La sortie PWM A (OC0) ne peut
+	donc pas être utilisée en même temps.
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include "utils.h"
+#include "uart.h"
+
+
+/* ----------------------------------------------------------------------------
+Defines et typedef
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Grosseur du buffer de trame
+
+	La norme permet des trames de 256 bytes, mais c'est le huitième de la RAM d'un
+	ATmega32. Avec 64 bytes, une seule requête peut lire jusqu'à 29 registres. Une
+	requête qui demande plus que ce que le buffer peut contenir reçoit l'exception
+	ILLEGAL DATA VALUE.
+*/
+#define MODBUS_FRAME_SIZE 64
+
+/**
+    \brief Adresse de broadcast. Les écritures sont faites, mais il n'y a pas de réponse.
+*/
+#define MODBUS_BROADCAST_ADDRESS 0
+
+/**
+    \brief Description d'un registre Modbus
+	\sa modbus_init
+
+	- read  : Retourne la valeur du registre. NULL si le registre ne peut pas être lu.
+	- write : Modifie le registre. NULL si le registre est en lecture seulement.
+	- arg   : Passé tel quel à read et à write. Permet d'utiliser la même fonction pour
+	          plusieurs registres semblables, par exemple un numéro de channel de l'ADC.
+*/
+typedef struct{
+
+	uint16_t (*read)(uint8_t arg);
+	void (*write)(uint8_t arg, uint16_t value);
+	uint8_t arg;
+
+}modbus_register_t;
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Fait l'initialisation de l'esclave Modbus
+    \param[in]  slave_address       L'adresse de l'esclave sur le bus (1 à 247)
+    \param[in]  baudrate            Le baudrate du bus
+    \param[in]  holding_registers   Table en flash (PROGMEM) des holding registers
+    \param[in]  holding_count       Nombre d'éléments de holding_registers
+    \param[in]  input_registers     Table en flash (PROGMEM) des input registers
+    \param[in]  input_count         Nombre d'éléments de input_registers
+
+	uart_init() doit avoir été appelée avant. Le module change le baudrate, met la
+	politique de transmission à UART_POLICY_BLOCK et détourne la réception vers
+	lui-même. uart_get_byte() et compagnie ne reçoivent donc plus rien.
+
+	Les interruptions doivent être activées pour que le module fonctionne.
+*/
+void modbus_init(uint8_t slave_address, baudrate_e baudrate,
+				 const modbus_register_t* holding_registers, uint8_t holding_count,
+				 const modbus_register_t* input_registers, uint8_t input_count);
+
+/**
+    \brief Traite la trame reçue s'il y en a une et envoie la réponse
+	\return TRUE si une trame a été traitée
+
+	Cette fonction doit être appelée le plus souvent possible dans la boucle
+	principale. Tant qu'une trame n'est pas traitée, les bytes reçus sont ignorés.
+	Les fonctions read et write des registres sont appelées d'ici, et non pas d'une
+	interruption.
+*/
+bool modbus_poll(void);
+
+
+#endif // MODBUS_H_INCLUDED
@@ -0,0 +1,249 @@
+#ifndef REG_H_INCLUDED
+#define REG_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file reg.h
+	\brief Accès atomiques aux bits des registres
+	\author Iouri Savard Colbert
+
+	Écrire PORTB = set_bit(PORTB, 3) lit le registre, modifie le bit et réécrit le
+	registre au complet. Si une interruption modifie un autre bit du même registre
+	entre la lecture et l'écriture, sa modification est perdue. Rien ne garantit
+	non plus que le compilateur utilise les instructions sbi et cbi.
+
+	Les macros de ce module choisissent la meilleure façon de faire au moment de
+	la compilation :
+
+	- Un seul bit connu à la compilation, dans les 32 premiers registres
+	d'entrée-sortie (PORTx, DDRx, PINx, UCSRA, UCSRB, ADCSRA, etc.) : une seule
+	instruction sbi ou cbi de 2 cycles, atomique par nature.
+	- Sinon (TIMSK, TCCRx, plusieurs bits, masque variable) : lecture-modification-
+	écriture avec les interruptions désactivées le temps de l'opération, puis
+	remises dans leur état d'avant.
+
+	Le registre et le bit peuvent être regroupés en un seul descripteur, ce qui
+	permet de déclarer une broche à un seul endroit :
+
+	\code
+
+	#define LED_PIN     PORTB, 3
+
+	reg_set_bit(LED_PIN);
+	reg_clear_bit(LED_PIN);
+
+	// Deux bits changés par une seule écriture du registre
+	reg_write_bits(TCCR2, (1 << CS22) | (1 << CS21) | (1 << CS20), (1 << CS21));
+
+	\endcode
+
+	Les instructions sbi et cbi ne sont utilisées que si le code est compilé avec
+	optimisation (-Os, -O1, etc.), sans quoi le compilateur ne peut pas savoir que
+	l'adresse et le bit sont des constantes. Sur l'ordinateur (tools/hd44780_model),
+	il n'y a pas d'interruption et les macros font une simple lecture-modification-
+	écriture.
+
+	\attention Sur l'ATmega32, sbi et cbi réécrivent eux aussi tous les bits du
+	registre. Les flags qui s'effacent en écrivant un 1 (TXC dans UCSRA, par
+	exemple) sont donc effacés s'ils étaient à 1, exactement comme avec
+	set_bit().
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "utils.h"
+
+
+/* ----------------------------------------------------------------------------
+Defines
+---------------------------------------------------------------------------- */
+
+#if defined(__AVR__) && defined(__OPTIMIZE__)
+
+/* Les registres que sbi et cbi peuvent rejoindre sont aux adresses mémoire 0x20 à 0x3F */
+#define REG_IS_BIT_ADDRESSABLE(reg) \
+	(__builtin_constant_p(_SFR_MEM_ADDR(reg)) && (_SFR_MEM_ADDR(reg) >= 0x20) && (_SFR_MEM_ADDR(reg) < 0x40))
+
+#define REG_IS_SINGLE_BIT(mask) \
+	(__builtin_constant_p(mask) && ((mask) != 0) && (((mask) & ((mask) - 1)) == 0))
+
+#define REG_CAN_USE_SBI(reg, mask) \
+	(REG_IS_BIT_ADDRESSABLE(reg) && REG_IS_SINGLE_BIT(mask))
+
+#define REG_SBI(reg, mask) \
+	__asm__ __volatile__("sbi %0, %1" : : "I" (_SFR_IO_ADDR(reg)), "I" (__builtin_ctz(mask)))
+
+#define REG_CBI(reg, mask) \
+	__asm__ __volatile__("cbi %0, %1" : : "I" (_SFR_IO_ADDR(reg)), "I" (__builtin_ctz(mask)))
+
+#else
+
+#define REG_CAN_USE_SBI(reg, mask)  0
+#define REG_SBI(reg, mask)
+#define REG_CBI(reg, mask)
+
+#endif
+
+#ifdef __AVR__
+
+/**
+    \brief Exécute statement avec les interruptions désactivées, puis les remet
+	dans leur état d'avant
+*/
+#define REG_ATOMIC(statement) \
+	do{ \
+		uint8_t reg_sreg_backup = SREG; \
+		cli(); \
+		statement; \
+		SREG = reg_sreg_backup; \
+	}while(0)
+
+#else
+
+#define REG_ATOMIC(statement) \
+	do{ \
+		statement; \
+	}while(0)
+
+#endif
+
+
+/* ----------------------------------------------------------------------------
+Macros
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Met à 1 les bits de mask dans reg, de façon atomique
+    \param[in,out]  reg     Le registre, par exemple PORTB
+    \param[in]      mask    Le masque des bits à mettre à 1
+*/
+#define reg_set_bits(reg, mask) \
+	do{ \
+		if(REG_CAN_USE_SBI(reg, mask)){ \
+			REG_SBI(reg, mask); \
+		} \
+		else{ \
+			REG_ATOMIC((reg) = set_bits((reg), (mask))); \
+		} \
+	}while(0)
+
+/**
+    \brief Met à 0 les bits de mask dans reg, de façon atomique
+    \param[in,out]  reg     Le registre, par exemple PORTB
+    \param[in]      mask    Le masque des bits à mettre à 0
+*/
+#define reg_clear_bits(reg, mask) \
+	do{ \
+		if(REG_CAN_USE_SBI(reg, mask)){ \
+			REG_CBI(reg, mask); \
+		} \
+		else{ \
+			REG_ATOMIC((reg) = clear_bits((reg), (mask))); \
+		} \
+	}while(0)
+
+/**
+    \brief Donne la valeur value aux bits de mask dans reg, en une seule écriture
+	du registre
+    \param[in,out]  reg     Le registre
+    \param[in]      mask    Le masque des bits à modifier
+    \param[in]      value   La nouvelle valeur des bits (les autres bits sont ignorés)
+
+	Si mask couvre tout le registre, il n'y a même pas de lecture.
+*/
+#define reg_write_bits(reg, mask, value) \
+	do{ \
+		if(__builtin_constant_p(mask) && (((mask) & 0xFF) == 0xFF)){ \
+			(reg) = (value); \
+		} \
+		else{ \
+			REG_ATOMIC((reg) = write_bits((reg), (mask), (value))); \
+		} \
+	}while(0)
+
+/**
+    \brief Inverse les bits de mask dans reg, de façon atomique
+
+	Il n'y a pas d'instruction pour inverser un bit sur l'ATmega32 : c'est toujours
+	une lecture-modification-écriture protégée.
+*/
+#define reg_toggle_bits(reg, mask) \
+	REG_ATOMIC((reg) = toggle_bits((reg), (mask)))
+
+/**
+    \brief Met à 1 un bit d'un registre, de façon atomique
+    \param  ... Le registre et le numéro du bit, ou un descripteur qui les contient
+
+	\code
+	reg_set_bit(UCSRB, UDRIE);      // sbi UCSRB, 5
+	\endcode
+*/
+#define reg_set_bit(...)            REG_SET_BIT(__VA_ARGS__)
+#define REG_SET_BIT(reg, bit)       reg_set_bits(reg, 1 << (bit))
+
+/**
+    \brief Met à 0 un bit d'un registre, de façon atomique
+    \param  ... Le registre et le numéro du bit, ou un descripteur qui les contient
+*/
+#define reg_clear_bit(...)          REG_CLEAR_BIT(__VA_ARGS__)
+#define REG_CLEAR_BIT(reg, bit)     reg_clear_bits(reg, 1 << (bit))
+
+/**
+    \brief Donne une valeur à un bit d'un registre, de façon atomique
+    \param  ... Le registre, le numéro du bit et la valeur (0 ou 1)
+
+	\code
+	reg_write_bit(LED_PIN, button_state);
+	\endcode
+*/
+#define reg_write_bit(...)          REG_WRITE_BIT(__VA_ARGS__)
+#define REG_WRITE_BIT(reg, bit, value) \
+	do{ \
+		if(value){ \
+			reg_set_bits(reg, 1 << (bit)); \
+		} \
+		else{ \
+			reg_clear_bits(reg, 1 << (bit)); \
+		} \
+	}while(0)
+
+/**
+    \brief Inverse un bit d'un registre, de façon atomique
+    \param  ... Le registre et le numéro du bit, ou un descripteur qui les contient
+*/
+#define reg_toggle_bit(...)         REG_TOGGLE_BIT(__VA_ARGS__)
+#define REG_TOGGLE_BIT(reg, bit)    reg_toggle_bits(reg, 1 << (bit))
+
+/**
+    \brief Lit un bit d'un registre (0 ou 1)
+    \param  ... Le registre et le numéro du bit, ou un descripteur qui les contient
+
+	Avec un registre d'entrée (PINx), le compilateur utilise sbis ou sbic dans un if.
+*/
+#define reg_read_bit(...)           REG_READ_BIT(__VA_ARGS__)
+#define REG_READ_BIT(reg, bit)      read_bit((reg), (bit))
+
+
+#endif // REG_H_INCLUDED
@@ -0,0 +1,381 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file shell.c
+	\brief Petit interpréteur de commandes texte reçues par le UART
+	\author Iouri Savard Colbert
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <avr/pgmspace.h>
+
+#include "shell.h"
+#include "uart.h"
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+#define BUCKET_MASK (SHELL_NB_BUCKETS - 1)
+
+/* Une case vide de la table de hash. Les cases pleines contiennent l'index de la
+commande + 1. */
+#define EMPTY_BUCKET 0
+
+#define HASH_INIT 5381
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+static const shell_command_t* command_table;
+static uint8_t buckets[SHELL_NB_BUCKETS];
+
+static char line_buffer[SHELL_LINE_SIZE];
+static uint8_t line_length;
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static uint16_t hash_update(uint16_t hash, char character);
+static uint16_t hash_name_P(const char* name);
+static bool name_equals_P(const char* string, const char* name);
+static bool is_separator(char character);
+
+
+/******************************************************************************
+Global functions
+******************************************************************************/
+
+bool shell_init(const shell_command_t* commands, uint8_t count){
+
+	uint8_t i;
+	uint8_t bucket;
+
+	command_table = commands;
+	line_length = 0;
+
+	for(i = 0; i < SHELL_NB_BUCKETS; i++){
+
+		buckets[i] = EMPTY_BUCKET;
+	}
+
+	/* Il faut toujours garder au moins une case vide pour que la recherche arrête */
+	if(count >= SHELL_NB_BUCKETS){
+
+		return FALSE;
+	}
+
+	for(i = 0; i < count; i++){
+
+		bucket = hash_name_P(commands[i].name) & BUCKET_MASK;
+
+		/* En cas de collision, on prend la prochaine case libre */
+		while(buckets[bucket] != EMPTY_BUCKET){
+
+			bucket = (bucket + 1) & BUCKET_MASK;
+		}
+
+		buckets[bucket] = i + 1;
+	}
+
+	return TRUE;
+}
+
+
+void shell_poll(void){
+
+	char character;
+
+	while(uart_is_rx_buffer_empty() == FALSE){
+
+		character = uart_get_byte();
+
+		if((character == '\r') || (character == '\n')){
+
+			/* Avec "\n\r", le deuxième caractère donne une ligne vide qui ne fait rien */
+			if(line_length > 0){
+
+#ifdef SHELL_ENABLE_ECHO
+				uart_put_string("\n\r");
+#endif
+
+				line_buffer[line_length] = '\0';
+				line_length = 0;
+
+				if(shell_execute(line_buffer) == FALSE){
+
+					uart_put_string("Commande inconnue\n\r");
+				}
+			}
+		}
+
+		else if((character == '\b') || (character == 0x7F)){
+
+			if(line_length > 0){
+
+				line_length--;
+
+#ifdef SHELL_ENABLE_ECHO
+				uart_put_string("\b \b");
+#endif
+			}
+		}
+
+		/* On garde une place pour le '\0' */
+		else if(line_length < SHELL_LINE_SIZE - 1){
+
+			line_buffer[line_length] = character;
+			line_length++;
+
+#ifdef SHELL_ENABLE_ECHO
+			uart_put_byte(character);
+#endif
+		}
+	}
+}
+
+
+bool shell_execute(char* line){
+
+	char* argv[SHELL_MAX_ARGS];
+	uint8_t argc = 0;
+	uint16_t hash = HASH_INIT;
+	uint8_t bucket;
+	uint8_t command;
+	shell_handler_t handler;
+
+	/* Découpage sur place. Le hash du premier mot se calcule en même temps. */
+	while(*line != '\0'){
+
+		while(is_separator(*line) == TRUE){
+
+			line++;
+		}
+
+		if(*line == '\0'){
+
+			break;
+		}
+
+		/* Les arguments en trop sont ignorés */
+		if(argc < SHELL_MAX_ARGS){
+
+			argv[argc] = line;
+		}
+
+		while((*line != '\0') && (is_separator(*line) == FALSE)){
+
+			if(argc == 0){
+
+				hash = hash_update(hash, *line);
+			}
+
+			line++;
+		}
+
+		if(*line != '\0'){
+
+			*line = '\0';
+			line++;
+		}
+
+		if(argc < SHELL_MAX_ARGS){
+
+			argc++;
+		}
+	}
+
+	if(argc == 0){
+
+		return TRUE;
+	}
+
+	bucket = hash & BUCKET_MASK;
+
+	while(buckets[bucket] != EMPTY_BUCKET){
+
+		command = buckets[bucket] - 1;
+
+		if(name_equals_P(argv[0], command_table[command].name) == TRUE){
+
+			handler = (shell_handler_t)pgm_read_word(&command_table[command].handler);
+
+			handler(argc, argv);
+
+			return TRUE;
+		}
+
+		bucket = (bucket + 1) & BUCKET_MASK;
+	}
+
+	return FALSE;
+}
+
+
+bool shell_parse_uint(const char* arg, uint32_t* value){
+
+	const char* digits = arg;
+	const char* end;
+	bool overflow;
+	uint32_t result;
+
+	if((arg[0] == '0') && (arg[1] == 'x')){
+
+		digits = &arg[2];
+		result = parse_hex_uint(digits, &end, &overflow);
+	}
+
+	else{
+
+		result = parse_uint(digits, &end, &overflow);
+	}
+
+	/* Aucun chiffre ("" ou "0x" tout seul), des caractères en trop ou un nombre
+	qui ne tient pas sur 32 bits */
+	if((end == digits) || (*end != '\0') || (overflow == TRUE)){
+
+		return FALSE;
+	}
+
+	*value = result;
+
+	return TRUE;
+}
+
+
+bool shell_parse_int(const char* arg, int32_t* value){
+
+	uint32_t magnitude;
+	bool negative = FALSE;
+
+	if(arg[0] == '-'){
+
+		negative = TRUE;
+		arg++;
+	}
+
+	else if(arg[0] == '+'){
+
+		arg++;
+	}
+
+	if(shell_parse_uint(arg, &magnitude) == FALSE){
+
+		return FALSE;
+	}
+
+	if(negative == TRUE){
+
+		if(magnitude > (uint32_t)INT32_MAX + 1){
+
+			return FALSE;
+		}
+
+		/* Le - 1 puis + 1 évite de faire -(INT32_MIN) qui ne tient pas */
+		*value = -(int32_t)(magnitude - 1) - 1;
+	}
+
+	else{
+
+		if(magnitude > INT32_MAX){
+
+			return FALSE;
+		}
+
+		*value = (int32_t)magnitude;
+	}
+
+	return TRUE;
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* djb2 : hash = hash * 33 ^ c. La multiplication par 33 se fait avec un shift et
+une addition, ce qui est très peu coûteux sur AVR. */
+static uint16_t hash_update(uint16_t hash, char character){
+
+	return ((hash << 5) + hash) ^ (uint8_t)character;
+}
+
+
+static uint16_t hash_name_P(const char* name){
+
+	uint16_t hash = HASH_INIT;
+	char character;
+	uint8_t i;
+
+	for(i = 0; i < SHELL_NAME_SIZE; i++){
+
+		character = pgm_read_byte(&name[i]);
+
+		if(character == '\0'){
+
+			break;
+		}
+
+		hash = hash_update(hash, character);
+	}
+
+	return hash;
+}
+
+
+static bool name_equals_P(const char* string, const char* name){
+
+	uint8_t i = 0;
+	char character;
+
+	do{
+
+		/* Un nom qui remplit tout SHELL_NAME_SIZE n'a pas de '\0' */
+		if(i >= SHELL_NAME_SIZE){
+
+			return (string[i] == '\0');
+		}
+
+		character = pgm_read_byte(&name[i]);
+
+		if(string[i] != character){
+
+			return FALSE;
+		}
+
+		i++;
+
+	}while(character != '\0');
+
+	return TRUE;
+}
+
+
+static bool is_separator(char character){
+
+	return ((character == ' ') || (character == '\t'));
+}
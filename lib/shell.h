@@ -0,0 +1,184 @@
+#ifndef SHELL_H_INCLUDED
+#define SHELL_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file shell.h
+	\brief Petit interpréteur de commandes texte reçues par le UART
+	\author Iouri Savard Colbert
+
+	Le module accumule les caractères reçus jusqu'à un '\\r' ou un '\\n', découpe la
+	ligne en arguments sur place (les espaces sont remplacés par des '\\0', rien
+	n'est copié) et appelle la fonction associée au premier mot.
+
+	La table des commandes reste en flash. Au moment de shell_init(), le hash du nom
+	de chaque commande est calculé une seule fois et rangé dans une petite table de
+	SHELL_NB_BUCKETS bytes en RAM. Le hash du premier mot est calculé pendant le
+	découpage de la ligne, alors trouver la commande ne coûte qu'un accès à la table
+	et une comparaison de nom, peu importe le nombre de commandes.
+
+	\code
+
+	static void cmd_pwm(uint8_t argc, char* argv[]){
+
+		uint32_t duty;
+
+		if((argc == 2) && (shell_parse_uint(argv[1], &duty) == TRUE)){
+
+			pwm_set_a(duty);
+		}
+	}
+
+	static const shell_command_t commands[] PROGMEM = {
+
+		{"pwm", cmd_pwm},
+		{"servo", cmd_servo},
+	};
+
+	uart_init();
+	shell_init(commands, 2);
+	sei();
+
+	while(1){
+
+		shell_poll();
+	}
+
+	\endcode
+*/
+
+/**
+    \brief Switch qui renvoie les caractères reçus au terminal
+
+    Si la switch est définie, l'utilisateur voit ce qu'il tape
+*/
+#define SHELL_ENABLE_ECHO
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include "utils.h"
+
+
+/* ----------------------------------------------------------------------------
+Defines et typedef
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Longueur maximale d'une ligne de commande, incluant le '\\0'
+*/
+#define SHELL_LINE_SIZE 32
+
+/**
+    \brief Nombre maximal d'arguments, incluant le nom de la commande
+*/
+#define SHELL_MAX_ARGS 6
+
+/**
+    \brief Longueur maximale du nom d'une commande, incluant le '\\0'
+*/
+#define SHELL_NAME_SIZE 8
+
+/**
+    \brief Grosseur de la table de hash. Doit être une puissance de 2 plus grande
+	que le nombre de commandes. Deux fois le nombre de commandes évite presque toutes
+	les collisions.
+*/
+#define SHELL_NB_BUCKETS 16
+
+/**
+    \brief Fonction appelée pour exécuter une commande
+    \param[in]  argc    Le nombre d'arguments, incluant le nom de la commande
+    \param[in]  argv    Les arguments. argv[0] est le nom de la commande.
+*/
+typedef void (*shell_handler_t)(uint8_t argc, char* argv[]);
+
+/**
+    \brief Une entrée de la table des commandes
+*/
+typedef struct{
+
+	char name[SHELL_NAME_SIZE];
+	shell_handler_t handler;
+
+}shell_command_t;
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Fait l'initialisation de l'interpréteur
+    \param[in]  commands    La table des commandes, en flash (PROGMEM)
+    \param[in]  count       Le nombre de commandes dans la table
+	\return FALSE si la table ne tient pas dans SHELL_NB_BUCKETS
+
+	uart_init() doit avoir été appelée avant.
+*/
+bool shell_init(const shell_command_t* commands, uint8_t count);
+
+/**
+    \brief Traite les caractères reçus par le UART et exécute la commande si une
+	ligne complète a été reçue
+
+	Cette fonction doit être appelée le plus souvent possible dans la boucle
+	principale. Elle ne bloque jamais. Les caractères '\\b' et 0x7F (DEL) effacent le
+	dernier caractère de la ligne. Les caractères qui dépassent SHELL_LINE_SIZE sont
+	ignorés.
+*/
+void shell_poll(void);
+
+/**
+    \brief Découpe et exécute une ligne de commande
+    \param[in,out]  line    La ligne à exécuter. Elle est modifiée par le découpage.
+	\return FALSE si la commande est inconnue
+
+	Permet d'exécuter des commandes qui ne viennent pas du UART. Une ligne vide
+	retourne TRUE sans rien faire.
+*/
+bool shell_execute(char* line);
+
+/**
+    \brief Converti un argument en entier non signé
+    \param[in]  arg     L'argument
+    \param[out] value   La valeur convertie
+	\return FALSE si l'argument n'est pas un nombre ou s'il ne tient pas sur 32 bits,
+	value n'est alors pas modifiée
+
+	Un argument qui commence par "0x" est lu en hexadécimal, avec les lettres en
+	majuscule ou en minuscule.
+*/
+bool shell_parse_uint(const char* arg, uint32_t* value);
+
+/**
+    \brief Converti un argument en entier signé
+    \param[in]  arg     L'argument
+    \param[out] value   La valeur convertie
+	\return FALSE si l'argument n'est pas un nombre ou s'il ne tient pas sur 32 bits
+	signés, value n'est alors pas modifiée
+
+	L'argument peut commencer par un '-' ou un '+'.
+*/
+bool shell_parse_int(const char* arg, int32_t* value);
+
+
+#endif // SHELL_H_INCLUDED
@@ -0,0 +1,159 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file trace.c
+	\brief Journalisation binaire par le UART, décodée sur l'ordinateur
+	\author Iouri Savard Colbert
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#include "trace.h"
+#include "uart.h"
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+/* Sync, id, length et timestamp */
+#define HEADER_SIZE 5
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+static volatile uint16_t timestamp;
+static uint16_t drop_count;
+
+
+/******************************************************************************
+Global functions
+******************************************************************************/
+
+void trace_init(void){
+
+	timestamp = 0;
+	drop_count = 0;
+}
+
+
+void trace_tick(void){
+
+	timestamp++;
+}
+
+
+bool trace_write(uint8_t id, const void* args, uint8_t length){
+
+	uint8_t record[HEADER_SIZE + TRACE_MAX_ARGS_SIZE];
+	uint8_t sreg_backup;
+	uint16_t now;
+
+	if(length > TRACE_MAX_ARGS_SIZE){
+
+		length = TRACE_MAX_ARGS_SIZE;
+	}
+
+	/* Le timestamp fait deux bytes et peut changer dans une interruption entre
+	les deux lectures */
+	sreg_backup = SREG;
+	cli();
+	now = timestamp;
+	SREG = sreg_backup;
+
+	/* Tout l'enregistrement doit entrer d'un coup, sinon le décodeur perd le fil */
+	if(uart_get_tx_free_space() < HEADER_SIZE + length){
+
+		drop_count++;
+
+		return FALSE;
+	}
+
+	record[0] = TRACE_SYNC_BYTE;
+	record[1] = id;
+	record[2] = length;
+	record[3] = (uint8_t)(now & 0xFF);
+	record[4] = (uint8_t)(now >> 8);
+
+	mem_copy(&record[HEADER_SIZE], args, length);
+
+	uart_put_bytes(record, HEADER_SIZE + length);
+
+	return TRUE;
+}
+
+
+bool trace_event(uint8_t id){
+
+	return trace_write(id, NULL, 0);
+}
+
+
+bool trace_uint8(uint8_t id, uint8_t value){
+
+	return trace_write(id, &value, 1);
+}
+
+
+bool trace_uint8_uint8(uint8_t id, uint8_t value_1, uint8_t value_2){
+
+	uint8_t args[2];
+
+	args[0] = value_1;
+	args[1] = value_2;
+
+	return trace_write(id, args, 2);
+}
+
+
+bool trace_uint16(uint8_t id, uint16_t value){
+
+	/* AVR est little endian, la valeur est déjà dans le bon ordre en mémoire */
+	return trace_write(id, &value, 2);
+}
+
+
+bool trace_uint16_uint16(uint8_t id, uint16_t value_1, uint16_t value_2){
+
+	uint16_t args[2];
+
+	args[0] = value_1;
+	args[1] = value_2;
+
+	return trace_write(id, args, 4);
+}
+
+
+bool trace_uint32(uint8_t id, uint32_t value){
+
+	return trace_write(id, &value, 4);
+}
+
+
+uint16_t trace_get_drop_count(void){
+
+	return drop_count;
+}
@@ -0,0 +1,169 @@
+#ifndef TRACE_H_INCLUDED
+#define TRACE_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file trace.h
+	\brief Journalisation binaire par le UART, décodée sur l'ordinateur
+	\author Iouri Savard Colbert
+
+	Plutôt que de formater un message texte avec uint16_to_string() et compagnie,
+	le microcontrôleur envoie seulement un numéro de message, un timestamp et les
+	valeurs brutes des arguments. Les strings de format ne sont jamais compilées
+	dans le programme; c'est l'outil tools/trace_decode.c qui reconstruit le texte
+	sur l'ordinateur.
+
+	Chaque enregistrement a la forme suivante (les valeurs de 16 et 32 bits sont
+	little endian, comme sur AVR) :
+
+		+------+----+--------+-----------+------------------+
+		| 0xA5 | id | length | timestamp | arguments ...    |
+		+------+----+--------+-----------+------------------+
+		   1     1      1          2         length bytes
+
+	Les messages sont décrits dans un fichier partagé par le programme et par le
+	décodeur, par exemple trace_messages.def :
+
+	\code
+
+	TRACE_MESSAGE(TRACE_BOOT,       "Démarrage")
+	TRACE_MESSAGE(TRACE_ADC,        "ADC %hhu = %hhu")
+	TRACE_MESSAGE(TRACE_SERVO,      "Servo A: %u us, servo B: %u us")
+	TRACE_MESSAGE(TRACE_ERROR,      "Erreur %lx")
+
+	\endcode
+
+	Les spécificateurs de format sont ceux de printf, avec les tailles d'un AVR :
+	%hh* fait 1 byte, %h* et %* font 2 bytes, %l* fait 4 bytes et %c fait 1 byte.
+
+	Du côté du programme, le fichier sert seulement à générer les numéros :
+
+	\code
+
+	typedef enum{
+
+	#define TRACE_MESSAGE(name, format) name,
+	#include "trace_messages.def"
+	#undef TRACE_MESSAGE
+
+	}trace_id_e;
+
+	trace_uint8_uint8(TRACE_ADC, channel, value);
+
+	\endcode
+
+	Et du côté de l'ordinateur :
+
+		trace_decode trace_messages.def capture.bin
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include "utils.h"
+
+
+/* ----------------------------------------------------------------------------
+Defines et typedef
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Premier byte de chaque enregistrement, permet au décodeur de se
+	resynchroniser après des bytes perdus
+*/
+#define TRACE_SYNC_BYTE 0xA5
+
+/**
+    \brief Nombre maximal de bytes d'arguments par enregistrement
+*/
+#define TRACE_MAX_ARGS_SIZE 8
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Fait l'initialisation du module
+
+	uart_init() doit avoir été appelée avant.
+*/
+void trace_init(void);
+
+/**
+    \brief Avance le timestamp d'une unité
+
+	Doit être appelée à intervalle régulier, typiquement d'une interruption de timer.
+	L'unité du timestamp est donc celle de l'appelant. Le compteur fait 16 bits et
+	recommence à 0 après 65535.
+*/
+void trace_tick(void);
+
+/**
+    \brief Envoie un enregistrement
+    \param[in]  id      Le numéro du message
+    \param[in]  args    Les arguments, tels qu'en mémoire
+    \param[in]  length  Le nombre de bytes d'arguments (TRACE_MAX_ARGS_SIZE au maximum)
+	\return FALSE si l'enregistrement a été perdu
+
+	La fonction ne bloque jamais. Si l'enregistrement n'entre pas au complet dans
+	le buffer de transmission, il est perdu au complet pour ne pas désynchroniser
+	le décodeur. Les pertes sont comptées par trace_get_drop_count().
+*/
+bool trace_write(uint8_t id, const void* args, uint8_t length);
+
+/**
+    \brief Envoie un enregistrement sans argument
+*/
+bool trace_event(uint8_t id);
+
+/**
+    \brief Envoie un enregistrement avec un argument de 8 bits (%hhu, %hhd, %c)
+*/
+bool trace_uint8(uint8_t id, uint8_t value);
+
+/**
+    \brief Envoie un enregistrement avec deux arguments de 8 bits
+*/
+bool trace_uint8_uint8(uint8_t id, uint8_t value_1, uint8_t value_2);
+
+/**
+    \brief Envoie un enregistrement avec un argument de 16 bits (%u, %d, %x)
+*/
+bool trace_uint16(uint8_t id, uint16_t value);
+
+/**
+    \brief Envoie un enregistrement avec deux arguments de 16 bits
+*/
+bool trace_uint16_uint16(uint8_t id, uint16_t value_1, uint16_t value_2);
+
+/**
+    \brief Envoie un enregistrement avec un argument de 32 bits (%lu, %ld, %lx)
+*/
+bool trace_uint32(uint8_t id, uint32_t value);
+
+/**
+    \brief Retourne le nombre d'enregistrements perdus depuis trace_init()
+*/
+uint16_t trace_get_drop_count(void);
+
+
+#endif // TRACE_H_INCLUDED
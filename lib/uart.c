@@ -24,6 +24,7 @@ Includes and defines
 #include "uart.h"
 
 #include "fifo.h"
+#include "reg.h"
 
 
 /******************************************************************************
@@ -76,11 +77,21 @@ static volatile uint8_t tx_buffer[UART_TX_BUFFER_SIZE];
 static fifo_t rx_fifo;
 static fifo_t tx_fifo;
 
+static uart_policy_e tx_policy;
+static volatile uart_policy_e rx_policy;
+
+static uint16_t tx_drop_count;
+static volatile uint16_t rx_drop_count;
+
+static volatile uart_rx_handler_t rx_handler;
+
 
 /******************************************************************************
 Static prototypes
 ******************************************************************************/
 
+static void write_UBRR(uint16_t ubrr);
+
 static void enable_UDRE_interupt(void);
 static void disable_UDRE_interupt(void);
 
@@ -112,7 +123,34 @@ ISR(USART_UDRE_vect){
 */
 ISR(USART_RXC_vect){
 
-    fifo_push(&rx_fifo, UDR);
+    uint8_t byte;
+
+    // Il faut absolument lire UDR, sinon l'interruption se déclenche à nouveau
+    byte = UDR;
+
+    if(rx_handler != NULL){
+
+        rx_handler(byte);
+    }
+
+    else if(fifo_is_full(&rx_fifo) == TRUE){
+
+        rx_drop_count++;
+
+        if(rx_policy == UART_POLICY_DROP_OLDEST){
+
+            // On fait de la place en sacrifiant le plus vieux byte
+            fifo_pop(&rx_fifo);
+        }
+
+        // Si le buffer est encore plein, fifo_push ignore simplement le byte
+        fifo_push(&rx_fifo, byte);
+    }
+
+    else{
+
+        fifo_push(&rx_fifo, byte);
+    }
 }
 
 
@@ -148,6 +186,13 @@ void uart_init(void){
     fifo_init(&rx_fifo, (uint8_t*)rx_buffer, UART_RX_BUFFER_SIZE);
     fifo_init(&tx_fifo, (uint8_t*)tx_buffer, UART_TX_BUFFER_SIZE);
 
+    tx_policy = DEFAULT_TX_POLICY;
+    rx_policy = DEFAULT_RX_POLICY;
+    tx_drop_count = 0;
+    rx_drop_count = 0;
+
+    rx_handler = NULL;
+
     uart_set_baudrate(DEFAULT_BAUDRATE);
 }
 
@@ -156,53 +201,313 @@ void uart_init(void){
 /// \todo (iouri#1#): implémenter qqch qui empêche la corruption de la transmission.  La mise à jour de UBRR est immédiate.  Voir doc p. 196
 void uart_set_baudrate(baudrate_e baudrate){
 
-    UBRRL = (uint8_t)(baudrate_to_UBRR[baudrate] & 0xFF);
-	UBRRH = (uint8_t)((baudrate_to_UBRR[baudrate] >> 8) & 0xFF);
+	// La table est calculée en vitesse normale, uart_auto_baudrate() a pu activer U2X
+	reg_clear_bit(UCSRA, U2X);
+
+    write_UBRR(baudrate_to_UBRR[baudrate]);
+}
+
+
+/*** uart_auto_baudrate ***/
+bool uart_auto_baudrate(bool allow_double_speed){
+
+	uint8_t sreg_backup;
+	uint8_t tccr1a_backup;
+	uint8_t tccr1b_backup;
+	uint8_t level;
+	uint8_t edge;
+	uint16_t cycles;
+	uint16_t ubrr_normal;
+	uint16_t ubrr_double;
+	uint16_t error_normal;
+	uint16_t error_double;
+	bool success = TRUE;
+
+	sreg_backup = SREG;
+	cli();
+
+	tccr1a_backup = TCCR1A;
+	tccr1b_backup = TCCR1B;
+
+	// Le byte de synchronisation ne doit pas se retrouver dans le buffer de réception
+	reg_clear_bit(UCSRB, RXEN);
+
+	// Timer 1 en mode normal, sans prescaler : un tick par cycle d'horloge
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+
+	// Si la ligne est déjà basse, on ne sait pas où on est rendu dans le byte
+	while(read_bit(PIND, PD0) == 0);
+
+	// Front descendant du bit de start
+	while(read_bit(PIND, PD0) == 1);
+
+	TCNT1 = 0;
+	TIFR = (1 << TOV1);	// Le flag s'efface en y écrivant un 1
+
+	level = 0;
+
+	// Avec 0x55, chaque bit change la ligne. Après le start il y a donc 9 fronts
+	// et le dernier (montant) est le début du bit de stop.
+	for(edge = 0; (edge < 9) && (success == TRUE); edge++){
+
+		while((read_bit(PIND, PD0) == level) && (success == TRUE)){
+
+			// Plus de 65535 cycles pour 9 bits, c'est sous les 2400 bauds
+			if(read_bit(TIFR, TOV1) == 1){
+
+				success = FALSE;
+			}
+		}
+
+		level ^= 1;
+	}
+
+	cycles = TCNT1;
+
+	TCCR1B = tccr1b_backup;
+	TCCR1A = tccr1a_backup;
+
+	if(success == TRUE){
+
+		// UBRR = Fosc / (16 * baud) - 1 et un bit dure Fosc / baud cycles, donc
+		// UBRR = cycles / (9 * 16) - 1 en vitesse normale et cycles / (9 * 8) - 1 avec U2X.
+		// Le + (diviseur / 2) sert à arrondir au plus proche.
+		ubrr_normal = (cycles + 72) / 144;
+		ubrr_double = (cycles + 36) / 72;
+
+		if(ubrr_double == 0){
+
+			// Plus rapide que ce que le UART peut suivre, même avec U2X
+			success = FALSE;
+		}
+
+		else{
+
+			// Erreur de chaque option, en cycles sur les 9 bits
+			error_normal = abs((int32_t)cycles - (int32_t)ubrr_normal * 144);
+			error_double = abs((int32_t)cycles - (int32_t)ubrr_double * 72);
+
+			if((allow_double_speed == TRUE) && ((ubrr_normal == 0) || (error_double < error_normal))){
+
+				reg_set_bit(UCSRA, U2X);
+				write_UBRR(ubrr_double - 1);
+			}
+
+			else if(ubrr_normal > 0){
+
+				reg_clear_bit(UCSRA, U2X);
+				write_UBRR(ubrr_normal - 1);
+			}
+
+			else{
+
+				success = FALSE;
+			}
+		}
+	}
+
+	// Le bit de stop est encore en cours, mais le récepteur se resynchronise sur le
+	// prochain bit de start de toute façon
+	reg_set_bit(UCSRB, RXEN);
+
+	SREG = sreg_backup;
+
+	return success;
+}
+
+
+
+/*** uart_set_tx_policy ***/
+void uart_set_tx_policy(uart_policy_e policy){
+
+    tx_policy = policy;
 }
 
 
+/*** uart_set_rx_policy ***/
+void uart_set_rx_policy(uart_policy_e policy){
+
+    rx_policy = policy;
+}
+
+
+/*** uart_set_rx_handler ***/
+void uart_set_rx_handler(uart_rx_handler_t handler){
+
+    // Un pointeur fait deux bytes, le ISR ne doit pas en lire une moitié
+    disable_RX_interupt();
+
+    rx_handler = handler;
+
+    enable_RX_interupt();
+}
+
+
+/*** uart_get_tx_drop_count ***/
+uint16_t uart_get_tx_drop_count(void){
+
+    return tx_drop_count;
+}
+
+
+/*** uart_get_rx_drop_count ***/
+uint16_t uart_get_rx_drop_count(void){
+
+    uint16_t count;
+
+    // Une variable de 16 bits se lit en deux instructions. Il ne faut pas que le ISR
+    // la modifie entre les deux.
+    disable_RX_interupt();
+
+    count = rx_drop_count;
+
+    enable_RX_interupt();
+
+    return count;
+}
+
+
+/*** uart_clear_drop_count ***/
+void uart_clear_drop_count(void){
+
+    disable_RX_interupt();
+
+    rx_drop_count = 0;
+
+    enable_RX_interupt();
+
+    tx_drop_count = 0;
+}
+
 
 /*** uart_put_byte ***/
-void uart_put_byte(uint8_t byte){
+uart_status_e uart_put_byte(uint8_t byte){
+
+    uart_status_e status = UART_STATUS_OK;
+
+    if(tx_policy == UART_POLICY_BLOCK){
+
+        // Le buffer ne peut être plein que si l'interrupt est activée, il va
+        // donc forcément finir par se vider
+        while(fifo_is_full(&tx_fifo) == TRUE);
+    }
 
     //on commence par désactiver l'interuption pour éviter que celle-ci
     //se produise pendant qu'on ajoute un caractère au buffer
     disable_UDRE_interupt();
 
+    if(fifo_is_full(&tx_fifo) == TRUE){
+
+        tx_drop_count++;
+
+        switch(tx_policy){
+        case UART_POLICY_DROP_OLDEST:
+
+            // On fait de la place en sacrifiant le plus vieux byte
+            fifo_pop(&tx_fifo);
+            status = UART_STATUS_DROPPED;
+            break;
+
+        case UART_POLICY_REJECT_MESSAGE:
+
+            status = UART_STATUS_REJECTED;
+            break;
+
+        default:
+
+            status = UART_STATUS_DROPPED;
+            break;
+        }
+    }
+
+    // Si le buffer est encore plein, fifo_push ignore simplement le byte
     fifo_push(&tx_fifo, byte);
 
     // On active l'interrupt après avoir incrémenté le pointeur
     // d'entré pour éviter un dead lock assez casse-tête
     enable_UDRE_interupt();
 
+    return status;
 }
 
 
-/*** uart_put_string ***/
-void uart_put_string(char* string){
+/*** uart_put_bytes ***/
+uart_status_e uart_put_bytes(const uint8_t* bytes, uint8_t length){
 	
 	uint8_t i = 0;
+	uart_status_e status = UART_STATUS_OK;
 	
-	while(string[i] != '\0'){
-		
-		while(fifo_is_full(&tx_fifo)  == TRUE);
+	if(tx_policy == UART_POLICY_REJECT_MESSAGE){
 		
-		//on commence par désactiver l'interuption pour éviter que celle-ci
-		//se produise pendant qu'on ajoute un caractère au buffer
 		disable_UDRE_interupt();
 		
-		while((string[i] != '\0') && (fifo_is_full(&tx_fifo)  == FALSE)){
+		// Le ISR ne peut que libérer de l'espace, donc si le message entre maintenant
+		// il va encore entrer quand on va le copier
+		if(length > fifo_get_free_space(&tx_fifo)){
 			
-			fifo_push(&tx_fifo, string[i]);
+			tx_drop_count += length;
 			
-			i++;
+			status = UART_STATUS_REJECTED;
 		}
+		
+		else{
+			
+			for(i = 0; i < length; i++){
+				
+				fifo_push(&tx_fifo, bytes[i]);
+			}
+		}
+		
+		// Si le buffer est vide, il ne faut pas réactiver l'interrupt pour rien
+		if(fifo_is_empty(&tx_fifo) == FALSE){
+			
+			enable_UDRE_interupt();
+		}
+	}
+	
+	else if(tx_policy == UART_POLICY_BLOCK){
+	
+		while(i < length){
+			
+			while(fifo_is_full(&tx_fifo)  == TRUE);
+			
+			//on commence par désactiver l'interuption pour éviter que celle-ci
+			//se produise pendant qu'on ajoute un caractère au buffer
+			disable_UDRE_interupt();
+			
+			while((i < length) && (fifo_is_full(&tx_fifo)  == FALSE)){
+				
+				fifo_push(&tx_fifo, bytes[i]);
+				
+				i++;
+			}
+
+			// On active l'interrupt après avoir incrémenté le pointeur
+			// d'entré pour éviter un dead lock assez casse-tête
+			enable_UDRE_interupt();
+		}
+	}
+	
+	else{
+		
+		for(i = 0; i < length; i++){
+			
+			if(uart_put_byte(bytes[i]) != UART_STATUS_OK){
+				
+				status = UART_STATUS_DROPPED;
+			}
+		}
+	}
+	
+	return status;
+}
 
-		// On active l'interrupt après avoir incrémenté le pointeur
-		// d'entré pour éviter un dead lock assez casse-tête
-		enable_UDRE_interupt();
 
-	}
+/*** uart_put_string ***/
+uart_status_e uart_put_string(char* string){
+	
+	return uart_put_bytes((const uint8_t*)string, string_length(string));
 }
 
 /*** uart_get_byte ***/
@@ -267,6 +572,23 @@ bool uart_is_rx_buffer_empty(void){
     return fifo_is_empty(&rx_fifo);
 }
 
+/*** uart_get_tx_free_space ***/
+uint8_t uart_get_tx_free_space(void){
+
+    uint8_t free_space;
+
+    disable_UDRE_interupt();
+
+    free_space = fifo_get_free_space(&tx_fifo);
+
+    if(fifo_is_empty(&tx_fifo) == FALSE){
+
+        enable_UDRE_interupt();
+    }
+
+    return free_space;
+}
+
 /*** is_tx_buffer_empty ***/
 bool uart_is_tx_buffer_empty(void){
 
@@ -278,22 +600,30 @@ bool uart_is_tx_buffer_empty(void){
 Static functions
 ******************************************************************************/
 
+static void write_UBRR(uint16_t ubrr){
+
+	// UBRRH doit être écrit en premier, UBRRL déclenche la mise à jour du prescaler.
+	// URSEL doit être à 0 puisque UBRRH partage son adresse avec UCSRC.
+	UBRRH = (uint8_t)((ubrr >> 8) & 0x0F);
+	UBRRL = (uint8_t)(ubrr & 0xFF);
+}
+
 static void enable_UDRE_interupt(void){
 
-	UCSRB = set_bit(UCSRB, UDRIE);
+	reg_set_bit(UCSRB, UDRIE);
 }
 
 static void disable_UDRE_interupt(void){
 
-    UCSRB = clear_bit(UCSRB, UDRIE);
+    reg_clear_bit(UCSRB, UDRIE);
 }
 
 static void enable_RX_interupt(void){
 
-    UCSRB = set_bit(UCSRB, RXCIE);
+    reg_set_bit(UCSRB, RXCIE);
 }
 
 static void disable_RX_interupt(void){
 
-    UCSRB = clear_bit(UCSRB, RXCIE);
+    reg_clear_bit(UCSRB, RXCIE);
 }
@@ -46,6 +46,64 @@ typedef enum{
 
 #define DEFAULT_BAUDRATE BAUDRATE_9600
 
+/**
+    \brief Le byte que le pair doit envoyer pour la détection automatique du baudrate
+    \sa uart_auto_baudrate(bool allow_double_speed)
+
+    0x55 ('U') donne une alternance parfaite de 0 et de 1 sur la ligne, ce qui fait
+    10 fronts bien espacés d'un bit chacun.
+*/
+#define AUTO_BAUDRATE_SYNC_BYTE 0x55
+
+
+/**
+    \brief Comportement d'un buffer lorsqu'il est plein
+    \sa uart_set_tx_policy(uart_policy_e policy)
+    \sa uart_set_rx_policy(uart_policy_e policy)
+
+    - UART_POLICY_BLOCK             : Attend patiement que de l'espace se libère
+    - UART_POLICY_DROP_NEWEST       : Le nouveau byte est perdu
+    - UART_POLICY_DROP_OLDEST       : Le plus vieux byte du buffer est écrasé. C'est
+                                      le bon choix pour de la télémétrie où seule la
+                                      donnée la plus fraîche compte.
+    - UART_POLICY_REJECT_MESSAGE    : Le message est ajouté au complet ou pas du tout.
+                                      C'est le bon choix pour des commandes de
+                                      configuration.
+*/
+typedef enum{
+
+    UART_POLICY_BLOCK = 0,
+    UART_POLICY_DROP_NEWEST,
+    UART_POLICY_DROP_OLDEST,
+    UART_POLICY_REJECT_MESSAGE,
+
+}uart_policy_e;
+
+/**
+    \brief Ce que retournent les fonctions qui ajoutent des bytes dans un buffer
+
+    - UART_STATUS_OK        : Tous les bytes ont été ajoutés sans rien perdre
+    - UART_STATUS_DROPPED   : Des bytes (les nouveaux ou les vieux selon la politique)
+                              ont été perdus
+    - UART_STATUS_REJECTED  : Le message au complet a été refusé, rien n'a été ajouté
+*/
+typedef enum{
+
+    UART_STATUS_OK = 0,
+    UART_STATUS_DROPPED,
+    UART_STATUS_REJECTED,
+
+}uart_status_e;
+
+/**
+    \brief Fonction appelée pour chaque byte reçu
+    \sa uart_set_rx_handler(uart_rx_handler_t handler)
+*/
+typedef void (*uart_rx_handler_t)(uint8_t byte);
+
+#define DEFAULT_TX_POLICY UART_POLICY_BLOCK
+#define DEFAULT_RX_POLICY UART_POLICY_DROP_NEWEST
+
 /******************************************************************************
 Prototypes
 ******************************************************************************/
@@ -62,23 +120,125 @@ void uart_init(void);
 void uart_set_baudrate(baudrate_e baudrate);
 
 
+/**
+    \brief Mesure le baudrate du pair et programme UBRR en conséquence
+    \param allow_double_speed   Si == TRUE, le bit U2X peut être activé lorsqu'il
+	donne une meilleure précision (typiquement à 115200 et plus)
+    \return TRUE si le baudrate a été détecté, FALSE si la mesure n'a pas de sens
+
+	Le pair doit envoyer AUTO_BAUDRATE_SYNC_BYTE ('U'). La fonction attend le bit de
+	start sur RXD (PD0), puis chronomètre avec le timer 1 les 9 bits qui séparent le
+	front descendant du start du front montant du stop. Le byte de synchronisation
+	n'est pas ajouté au buffer de réception.
+
+	Cette fonction bloque (avec les interruptions désactivées) jusqu'à ce que le
+	byte de synchronisation arrive. Elle est donc faite pour être appelée une seule
+	fois au démarrage, après uart_init(). Le timer 1 est emprunté pendant la mesure
+	et sa configuration est restaurée avant de retourner, mais son compteur est perdu.
+
+	En cas d'échec (pair trop lent, bruit sur la ligne), le baudrate n'est pas modifié.
+*/
+bool uart_auto_baudrate(bool allow_double_speed);
+
+
+/**
+    \brief Choisi ce qui se produit lorsque le buffer de transmission est plein
+    \param policy   La politique à appliquer
+
+    Par défaut, la politique est DEFAULT_TX_POLICY
+*/
+void uart_set_tx_policy(uart_policy_e policy);
+
+
+/**
+    \brief Choisi ce qui se produit lorsque le buffer de réception est plein
+    \param policy   La politique à appliquer
+
+    Par défaut, la politique est DEFAULT_RX_POLICY.  Comme la réception se fait
+	dans une interruption, il est impossible d'y attendre. Il n'y a pas non plus de
+	notion de message en réception. UART_POLICY_BLOCK et UART_POLICY_REJECT_MESSAGE
+	se comportent donc comme UART_POLICY_DROP_NEWEST.
+*/
+void uart_set_rx_policy(uart_policy_e policy);
+
+
+/**
+    \brief Détourne les bytes reçus vers une fonction plutôt que vers le buffer
+	de réception
+    \param handler   La fonction à appeler pour chaque byte reçu ou NULL pour revenir
+	au fonctionnement normal
+
+	Sert aux protocoles qui doivent traiter chaque byte au moment où il arrive (par
+	exemple pour calculer un CRC au vol) sans le copier une deuxième fois.
+
+	\warning handler est appelée à l'intérieur de l'interruption de réception. Elle
+	doit donc être très courte et ne jamais attendre.
+*/
+void uart_set_rx_handler(uart_rx_handler_t handler);
+
+
+/**
+    \brief Retourne le nombre de bytes perdus ou refusés en transmission depuis
+	le dernier appel à uart_clear_drop_count()
+*/
+uint16_t uart_get_tx_drop_count(void);
+
+
+/**
+    \brief Retourne le nombre de bytes perdus en réception depuis le dernier appel
+	à uart_clear_drop_count()
+*/
+uint16_t uart_get_rx_drop_count(void);
+
+
+/**
+    \brief Remet à zéro les deux compteurs de bytes perdus
+*/
+void uart_clear_drop_count(void);
+
+
 /**
     \brief Ajoute un byte au rolling buffer à envoyer par le UART
     \param byte le byte à ajouter
+	\return UART_STATUS_OK si rien n'a été perdu
+
+	Si le buffer est plein, le comportement dépend de la politique choisie avec
+	uart_set_tx_policy(). Pour un seul byte, UART_POLICY_REJECT_MESSAGE se comporte
+	comme UART_POLICY_DROP_NEWEST, sauf que c'est UART_STATUS_REJECTED qui est retourné.
 */
-void uart_put_byte(uint8_t byte);
+uart_status_e uart_put_byte(uint8_t byte);
 
 
 /**
     \brief Ajoute la string (par copie) au rolling buffer à envoyer par le UART.
     \param un pointeur sur le premier char de la string
+	\return UART_STATUS_OK si rien n'a été perdu
 	
 	La copie s'arrête au premier \0. Ce dernier n'est pas copié. Si la string est plus
-	longue que l'espace qui est libre dans le buffer, la fonction va patiement attendre
-	que de l'espace se libère. Dans cette situation, cette fonction peut être très longue
-	à retourner, ce qui pourrait briser des timmings critiques dans le code.
+	longue que l'espace qui est libre dans le buffer, le comportement dépend de la
+	politique choisie avec uart_set_tx_policy() :
+
+	- UART_POLICY_BLOCK : la fonction va patiement attendre que de l'espace se libère.
+	Dans cette situation, cette fonction peut être très longue à retourner, ce qui
+	pourrait briser des timmings critiques dans le code.
+	- UART_POLICY_DROP_NEWEST : ce qui dépasse de la string est perdu.
+	- UART_POLICY_DROP_OLDEST : les plus vieux bytes du buffer sont écrasés.
+	- UART_POLICY_REJECT_MESSAGE : si la string n'entre pas au complet, rien n'est
+	ajouté. Une string plus longue que UART_TX_BUFFER_SIZE est toujours refusée.
+*/
+uart_status_e uart_put_string(char* string);
+
+
+/**
+    \brief Ajoute un bloc de bytes (par copie) au rolling buffer à envoyer par le UART.
+    \param bytes     Pointeur sur le premier byte
+    \param length    Le nombre de bytes à ajouter
+	\return UART_STATUS_OK si rien n'a été perdu
+
+	Identique à uart_put_string(), mais pour des données binaires qui peuvent
+	contenir des 0.
 */
-void uart_put_string(char* string);
+uart_status_e uart_put_bytes(const uint8_t* bytes, uint8_t length);
 
 /**
     \brief Retire un byte au rolling buffer reçu par le UART.
@@ -142,6 +302,15 @@ void uart_flush(void);
 */
 bool uart_is_rx_buffer_empty(void);
 
+/**
+    \brief Retourne le nombre de bytes qui peuvent être ajoutés au buffer de
+	transmission sans qu'il soit plein.
+
+	Comme le buffer ne peut que se vider entre deux appels, un message plus petit
+	ou égal à cette valeur est assuré d'entrer au complet.
+*/
+uint8_t uart_get_tx_free_space(void);
+
 /**
     \brief Indique si le buffer de transmission est vide.
     \param TRUE si il est vide, FALSE s'il contient 1 byte ou plus
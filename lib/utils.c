@@ -21,15 +21,279 @@ Includes
 #include "utils.h"
 
 
+/******************************************************************************
+Defines
+******************************************************************************/
+
+/* Nombre maximal de chiffres d'un entier de 32 bits */
+#define UINT32_MAX_DIGITS 10
+
+#ifndef __AVR__
+
+/* Un mot de la machine. may_alias permet de lire n'importe quel bloc de bytes
+avec ce type sans briser les règles d'aliasing du compilateur. */
+typedef uintptr_t __attribute__((__may_alias__)) word_t;
+
+#define WORD_MASK (sizeof(word_t) - 1)
+
+#endif
+
+/* Retourné par hex_digit_value() pour un caractère qui n'est pas un chiffre */
+#define NOT_A_DIGIT 0xFF
+
+/* Plus grande valeur qui peut encore être multipliée par 10 sans déborder */
+#define UINT32_MAX_DIV10 429496729UL
+
+/* Caractère qui remplit un champ trop petit pour le nombre */
+#define OVERFLOW_CHAR '*'
+
+/* Quotient par 10 sans division, par multiplication par l'inverse. Les
+multiplications 8 et 16 bits se font avec l'instruction MUL de l'AVR.
+205 / 2^11 est exact pour n < 1029 et 0xCCCD / 2^19 pour tout n de 16 bits. */
+#define DIV10_U8(n)     ((uint8_t)(((uint16_t)(n) * 205U) >> 11))
+#define DIV10_U16(n)    ((uint16_t)(((uint32_t)(n) * 0xCCCDUL) >> 19))
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static uint8_t hex_digit_value(char character);
+static bool accumulate_decimal(uint32_t* value, uint8_t digit);
+static bool accumulate_hex(uint32_t* value, uint8_t digit);
+static uint32_t end_parse(const char* stop, uint32_t value, bool out_of_range, const char** end, bool* overflow);
+static int32_t to_signed(uint32_t magnitude, bool negative, bool* out_of_range);
+static uint32_t div10_u32(uint32_t number);
+static uint8_t write_digits(char* end, uint32_t number);
+static uint8_t write_fixed(char* out_string, uint32_t number, uint8_t width);
+static uint8_t write_aligned(char* out_string, uint32_t magnitude, bool negative, uint8_t width, char padding);
+
+
 /** Memory management **********************************************************/
-void mem_copy(void * destination, const void * source, uint8_t num ){
 
-    uint8_t i;
+/* Sur AVR, les boucles avancent un pointeur avec post-incrément (ld X+ / st Z+)
+et font 4 bytes par tour pour amortir le test de fin de boucle. Sur l'ordinateur
+(par exemple tools/hd44780_model), les blocs sont copiés un mot à la fois dès que
+la source et la destination ont le même alignement. */
+
+void mem_copy(void * destination, const void * source, uint16_t num ){
+
+    uint8_t* out = (uint8_t*)destination;
+    const uint8_t* in = (const uint8_t*)source;
+
+#ifdef __AVR__
+
+    uint8_t rest = num & 0x03;
+
+    num >>= 2;
+
+    while(rest > 0){
+
+        *out++ = *in++;
+        rest--;
+    }
+
+    while(num > 0){
+
+        *out++ = *in++;
+        *out++ = *in++;
+        *out++ = *in++;
+        *out++ = *in++;
+        num--;
+    }
+
+#else
+
+    if(((uintptr_t)out & WORD_MASK) == ((uintptr_t)in & WORD_MASK)){
+
+        while((num > 0) && (((uintptr_t)out & WORD_MASK) != 0)){
+
+            *out++ = *in++;
+            num--;
+        }
+
+        while(num >= sizeof(word_t)){
+
+            *(word_t*)out = *(const word_t*)in;
+            out += sizeof(word_t);
+            in += sizeof(word_t);
+            num -= sizeof(word_t);
+        }
+    }
+
+    while(num > 0){
+
+        *out++ = *in++;
+        num--;
+    }
+
+#endif
+}
+
+
+void mem_set(void * destination, uint8_t value, uint16_t num ){
+
+    uint8_t* out = (uint8_t*)destination;
+
+#ifdef __AVR__
+
+    uint8_t rest = num & 0x03;
+
+    num >>= 2;
 
-    for(i = 0; i < num; i++){
+    while(rest > 0){
 
-        ((uint8_t*)destination)[i] = ((uint8_t*)source)[i];
+        *out++ = value;
+        rest--;
     }
+
+    while(num > 0){
+
+        *out++ = value;
+        *out++ = value;
+        *out++ = value;
+        *out++ = value;
+        num--;
+    }
+
+#else
+
+    /* Le byte répété dans chaque byte du mot */
+    word_t pattern = ((word_t)-1 / 0xFF) * value;
+
+    while((num > 0) && (((uintptr_t)out & WORD_MASK) != 0)){
+
+        *out++ = value;
+        num--;
+    }
+
+    while(num >= sizeof(word_t)){
+
+        *(word_t*)out = pattern;
+        out += sizeof(word_t);
+        num -= sizeof(word_t);
+    }
+
+    while(num > 0){
+
+        *out++ = value;
+        num--;
+    }
+
+#endif
+}
+
+
+int8_t mem_compare(const void * block_1, const void * block_2, uint16_t num ){
+
+    const uint8_t* left = (const uint8_t*)block_1;
+    const uint8_t* right = (const uint8_t*)block_2;
+
+#ifndef __AVR__
+
+    /* On saute les mots identiques, le byte qui diffère est trouvé plus bas */
+    if(((uintptr_t)left & WORD_MASK) == ((uintptr_t)right & WORD_MASK)){
+
+        while((num > 0) && (((uintptr_t)left & WORD_MASK) != 0) && (*left == *right)){
+
+            left++;
+            right++;
+            num--;
+        }
+
+        if(((uintptr_t)left & WORD_MASK) == 0){
+
+            while((num >= sizeof(word_t)) && (*(const word_t*)left == *(const word_t*)right)){
+
+                left += sizeof(word_t);
+                right += sizeof(word_t);
+                num -= sizeof(word_t);
+            }
+        }
+    }
+
+#endif
+
+    while(num > 0){
+
+        if(*left != *right){
+
+            return (*left < *right) ? -1 : 1;
+        }
+
+        left++;
+        right++;
+        num--;
+    }
+
+    return 0;
+}
+
+
+void mem_move(void * destination, const void * source, uint16_t num ){
+
+    uint8_t* out = (uint8_t*)destination;
+    const uint8_t* in = (const uint8_t*)source;
+
+    /* Une copie vers l'avant ne peut écraser que ce qui a déjà été lu */
+    if((out <= in) || (out >= in + num)){
+
+        mem_copy(destination, source, num);
+
+        return;
+    }
+
+    /* Sinon on copie à partir de la fin */
+    out += num;
+    in += num;
+
+#ifdef __AVR__
+
+    uint8_t rest = num & 0x03;
+
+    num >>= 2;
+
+    while(rest > 0){
+
+        *--out = *--in;
+        rest--;
+    }
+
+    while(num > 0){
+
+        *--out = *--in;
+        *--out = *--in;
+        *--out = *--in;
+        *--out = *--in;
+        num--;
+    }
+
+#else
+
+    if(((uintptr_t)out & WORD_MASK) == ((uintptr_t)in & WORD_MASK)){
+
+        while((num > 0) && (((uintptr_t)out & WORD_MASK) != 0)){
+
+            *--out = *--in;
+            num--;
+        }
+
+        while(num >= sizeof(word_t)){
+
+            out -= sizeof(word_t);
+            in -= sizeof(word_t);
+            *(word_t*)out = *(const word_t*)in;
+            num -= sizeof(word_t);
+        }
+    }
+
+    while(num > 0){
+
+        *--out = *--in;
+        num--;
+    }
+
+#endif
 }
 
 
@@ -77,19 +341,15 @@ uint8_t char_to_uint(char caracter){
 }
 
 
+/* Méthode de Horner : une seule passe de gauche à droite, sans puissance de 10 */
 uint32_t string_to_uint(const char* string){
 
-    uint8_t string_index;
-    uint32_t power_of_ten = 1;
     uint32_t converted_uint = 0;
 
-    string_index = string_length(string);
-
-    while(string_index > 0){
+    while(*string != '\0'){
 
-        converted_uint += (char_to_uint(string[string_index - 1])) * power_of_ten;
-        string_index--;
-        power_of_ten = power_of_ten * 10;
+        converted_uint = (converted_uint * 10) + char_to_uint(*string);
+        string++;
     }
 
     return converted_uint;
@@ -97,14 +357,13 @@ uint32_t string_to_uint(const char* string){
 
 uint32_t char_array_to_uint(const char* char_array, uint8_t size){
 
-    uint32_t power_of_ten = 1;
     uint32_t converted_uint = 0;
 
     while(size > 0){
 
-        converted_uint += (char_to_uint(char_array[size - 1])) * power_of_ten;
+        converted_uint = (converted_uint * 10) + char_to_uint(*char_array);
+        char_array++;
         size--;
-        power_of_ten = power_of_ten * 10;
     }
 
     return converted_uint;
@@ -113,16 +372,11 @@ uint32_t char_array_to_uint(const char* char_array, uint8_t size){
 
 uint8_t hex_char_to_uint(char caracter){
 
-    uint8_t nibble = 0;
-
-    if((caracter >= '0') && (caracter <= '9')){
-
-        nibble = caracter - '0';
-    }
+    uint8_t nibble = hex_digit_value(caracter);
 
-    else if((caracter >= 'a') && (caracter <= 'f')){
+    if(nibble == NOT_A_DIGIT){
 
-        nibble = caracter - 'a' + 0xA;
+        nibble = 0;
     }
 
     return nibble;
@@ -131,17 +385,12 @@ uint8_t hex_char_to_uint(char caracter){
 
 uint32_t hex_string_to_uint(const char* string){
 
-    uint8_t string_index;
-    uint8_t nibble_count = 0;
     uint32_t converted_uint = 0;
 
-    string_index = string_length(string);
+    while(*string != '\0'){
 
-    while(string_index > 0){
-
-        converted_uint |= (hex_char_to_uint(string[string_index - 1])) << (4 * nibble_count);
-        string_index--;
-        nibble_count++;
+        converted_uint = (converted_uint << 4) | hex_char_to_uint(*string);
+        string++;
     }
 
     return converted_uint;
@@ -149,137 +398,261 @@ uint32_t hex_string_to_uint(const char* string){
 
 uint32_t hex_char_array_to_uint(const char* char_array, uint8_t size){
 
-    uint8_t nibble_count = 0;
     uint32_t converted_uint = 0;
 
     while(size > 0){
 
-        converted_uint |= (hex_char_to_uint(char_array[size - 1])) << (4 * nibble_count);
+        converted_uint = (converted_uint << 4) | hex_char_to_uint(*char_array);
+        char_array++;
         size--;
-        nibble_count++;
     }
 
     return converted_uint;
 }
 
 
-/** Conversion number to text ************************************************/
+uint32_t parse_uint(const char* string, const char** end, bool* overflow){
 
-char uint_to_char(uint8_t digit){
+    uint32_t value = 0;
+    bool out_of_range = FALSE;
+    uint8_t digit;
 
-    char caracter = '\0';
+    /* Un caractère plus petit que '0' donne un très grand digit une fois non signé */
+    while((digit = (uint8_t)(*string - '0')) <= 9){
 
-    if((digit >= 0) && (digit <= 9)){
+        if(accumulate_decimal(&value, digit) == FALSE){
 
-        caracter = digit + '0';
+            out_of_range = TRUE;
+        }
+
+        string++;
     }
 
-    return caracter;
+    return end_parse(string, value, out_of_range, end, overflow);
 }
 
 
-char uint_to_hex_char(uint8_t hex_digit){
+uint32_t parse_hex_uint(const char* string, const char** end, bool* overflow){
 
-	char caracter = '\0';
+    uint32_t value = 0;
+    bool out_of_range = FALSE;
+    uint8_t digit;
 
-	if((hex_digit >= 0x00) && (hex_digit <= 0x09)){
+    while((digit = hex_digit_value(*string)) != NOT_A_DIGIT){
 
-		caracter = hex_digit + '0';
-	}
-	
-	else if((hex_digit >= 0x0A) && (hex_digit <= 0x0F)){
-		
-		caracter = hex_digit + 'A';
-	}
+        if(accumulate_hex(&value, digit) == FALSE){
 
-	return caracter;
+            out_of_range = TRUE;
+        }
+
+        string++;
+    }
+
+    return end_parse(string, value, out_of_range, end, overflow);
 }
 
 
-uint8_t uint8_to_string(char* out_string, uint8_t number){
+int32_t parse_int(const char* string, const char** end, bool* overflow){
 
-    uint8_t anti_rest;  //après avoir fixé mon écran dans le vide pendant 15 minutes à chercher
-    // un nom intelligent pour cette variable j'ai décidé de passer à l'action et de lui donner
-    // le premier nom qui me passerait par la tête.
-    uint8_t string_index = 0;
-    uint8_t power_of_ten = 100;
+    const char* digits = string;
+    const char* digits_end;
+    uint32_t magnitude;
+    bool out_of_range;
+    bool negative = FALSE;
+    int32_t value;
 
+    if(*digits == '-'){
 
-    while(power_of_ten > 0){
+        negative = TRUE;
+        digits++;
+    }
 
-        anti_rest = number / power_of_ten;
+    else if(*digits == '+'){
 
-        out_string[string_index] = uint_to_char(anti_rest);
+        digits++;
+    }
 
-        number -= anti_rest * power_of_ten;
+    magnitude = parse_uint(digits, &digits_end, &out_of_range);
 
-        string_index++;
+    /* Un signe tout seul n'est pas un nombre, on ne le consomme pas */
+    if(digits_end == digits){
 
-        power_of_ten /= 10;
+        digits_end = string;
     }
 
-    /* On ferme la string */
-    out_string[string_index] = '\0';
-	
-	return string_index;
+    value = to_signed(magnitude, negative, &out_of_range);
+
+    if(end != NULL){
+
+        *end = digits_end;
+    }
+
+    if(overflow != NULL){
+
+        *overflow = out_of_range;
+    }
+
+    return value;
 }
 
 
-uint8_t uint16_to_string(char* out_string, uint16_t number){
+void number_parser_init(number_parser_t* parser, uint8_t base){
+
+    parser->value = 0;
+    parser->base = base;
+    parser->digit_count = 0;
+    parser->negative = FALSE;
+    parser->has_sign = FALSE;
+    parser->overflow = FALSE;
+}
 
-    uint8_t anti_rest;  //après avoir fixé mon écran dans le vide pendant 15 minutes à chercher
-    // un nom intelligetn pour cette variable j'ai décidé de passer à l'action et de lui donner
-    // le premier nom qui me passerait par la tête.
-    uint8_t string_index = 0;
-    uint16_t power_of_ten = 10000;
 
+bool number_parser_feed(number_parser_t* parser, char character){
 
-    while(power_of_ten > 0){
+    uint8_t digit;
+    bool accepted;
 
-        anti_rest = number / power_of_ten;
+    if(parser->base == 16){
 
-        out_string[string_index] = uint_to_char(anti_rest);
+        digit = hex_digit_value(character);
+    }
+
+    else{
 
-        number -= anti_rest * power_of_ten;
+        digit = (uint8_t)(character - '0');
 
-        string_index++;
+        if(digit > 9){
 
-        power_of_ten /= 10;
+            digit = NOT_A_DIGIT;
+        }
     }
 
-    /* On ferme la string */
-    out_string[string_index] = '\0';
-	
-	return string_index;
+    if(digit == NOT_A_DIGIT){
+
+        /* Le signe n'est accepté qu'une fois, avant le premier chiffre */
+        if(((character == '-') || (character == '+')) && (parser->digit_count == 0) && (parser->has_sign == FALSE)){
+
+            parser->has_sign = TRUE;
+            parser->negative = (character == '-');
+
+            return TRUE;
+        }
+
+        return FALSE;
+    }
+
+    if(parser->base == 16){
+
+        accepted = accumulate_hex(&parser->value, digit);
+    }
+
+    else{
+
+        accepted = accumulate_decimal(&parser->value, digit);
+    }
+
+    if(accepted == FALSE){
+
+        parser->overflow = TRUE;
+    }
+
+    /* Pas besoin de compter plus loin, seul "aucun chiffre" nous intéresse */
+    if(parser->digit_count < 0xFF){
+
+        parser->digit_count++;
+    }
+
+    return TRUE;
 }
 
 
-uint8_t uint32_to_string(char* out_string, uint32_t number){
+bool number_parser_get_uint(const number_parser_t* parser, uint32_t* value){
 
-    uint8_t anti_rest;  //après avoir fixé mon écran dans le vide pendant 15 minutes à chercher
-    // un nom intelligetn pour cette variable j'ai décidé de passer à l'action et de lui donner
-    // le premier nom qui me passerait par la tête.
-    uint8_t string_index = 0;
-    uint32_t power_of_ten = 1000000000;
+    if((parser->digit_count == 0) || (parser->negative == TRUE)){
 
+        *value = 0;
 
-    while(power_of_ten > 0){
+        return FALSE;
+    }
 
-        anti_rest = number / power_of_ten;
+    if(parser->overflow == TRUE){
 
-        out_string[string_index] = uint_to_char(anti_rest);
+        *value = UINT32_MAX;
 
-        number -= anti_rest * power_of_ten;
+        return FALSE;
+    }
 
-        string_index++;
+    *value = parser->value;
 
-        power_of_ten /= 10;
+    return TRUE;
+}
+
+
+bool number_parser_get_int(const number_parser_t* parser, int32_t* value){
+
+    bool out_of_range = parser->overflow;
+
+    if(parser->digit_count == 0){
+
+        *value = 0;
+
+        return FALSE;
     }
 
-    /* On ferme la string */
-    out_string[string_index] = '\0';
+    *value = to_signed(parser->value, parser->negative, &out_of_range);
+
+    return (out_of_range == FALSE);
+}
+
+
+/** Conversion number to text ************************************************/
+
+char uint_to_char(uint8_t digit){
+
+    char caracter = '\0';
+
+    if((digit >= 0) && (digit <= 9)){
+
+        caracter = digit + '0';
+    }
+
+    return caracter;
+}
+
+
+char uint_to_hex_char(uint8_t hex_digit){
+
+	char caracter = '\0';
+
+	if((hex_digit >= 0x00) && (hex_digit <= 0x09)){
+
+		caracter = hex_digit + '0';
+	}
 	
-	return string_index;
+	else if((hex_digit >= 0x0A) && (hex_digit <= 0x0F)){
+		
+		caracter = hex_digit - 0x0A + 'A';
+	}
+
+	return caracter;
+}
+
+
+uint8_t uint8_to_string(char* out_string, uint8_t number){
+
+	return write_fixed(out_string, number, 3);
+}
+
+
+uint8_t uint16_to_string(char* out_string, uint16_t number){
+
+	return write_fixed(out_string, number, 5);
+}
+
+
+uint8_t uint32_to_string(char* out_string, uint32_t number){
+
+	return write_fixed(out_string, number, 10);
 }
 
 
@@ -335,7 +708,7 @@ uint8_t int8_to_string(char* out_string, int8_t number){
 
     /* Une fois que le signe est sorti, reste juste à convertir la valeur absolue du reste */
 	// Le +1 c'est pour tenir compte du signe
-    return uint8_to_string(&out_string[1], (uint8_t)abs(number)) + 1;
+    return uint8_to_string(&out_string[1], (number < 0) ? (uint8_t)-(uint8_t)number : (uint8_t)number) + 1;
 }
 
 
@@ -353,7 +726,7 @@ uint8_t int16_to_string(char* out_string, int16_t number){
 
     /* Une fois que le signe est sorti, reste juste à convertir la valeur absolue du reste */
 	// Le +1 c'est pour tenir compte du signe
-    return uint16_to_string(&out_string[1], (uint16_t)abs(number)) + 1;
+    return uint16_to_string(&out_string[1], (number < 0) ? (uint16_t)-(uint16_t)number : (uint16_t)number) + 1;
 
 }
 
@@ -372,6 +745,290 @@ uint8_t int32_to_string(char* out_string, int32_t number){
 
     /* Une fois que le signe est sorti, reste juste à convertir la valeur absolue du reste */
 	// Le +1 c'est pour tenir compte du signe
-    return uint32_to_string(&out_string[1], (uint32_t)abs(number)) + 1;
+    // Pas de abs() : celui d'avr-libc prend un int de 16 bits. La négation en
+    // non signé donne aussi la bonne magnitude pour INT32_MIN.
+    return uint32_to_string(&out_string[1], (number < 0) ? -(uint32_t)number : (uint32_t)number) + 1;
+
+}
+
+
+uint8_t uint32_to_string_unpadded(char* out_string, uint32_t number){
+
+	return write_aligned(out_string, number, FALSE, 0, ' ');
+}
+
+
+uint8_t int32_to_string_unpadded(char* out_string, int32_t number){
+
+	// La négation se fait en non signé pour que -2147483648 fonctionne
+	if(number < 0){
+
+		return write_aligned(out_string, -(uint32_t)number, TRUE, 0, ' ');
+	}
+
+	return write_aligned(out_string, (uint32_t)number, FALSE, 0, ' ');
+}
+
+
+uint8_t uint32_to_string_aligned(char* out_string, uint32_t number, uint8_t width, char padding){
+
+	return write_aligned(out_string, number, FALSE, width, padding);
+}
+
+
+uint8_t int32_to_string_aligned(char* out_string, int32_t number, uint8_t width, char padding){
+
+	if(number < 0){
+
+		return write_aligned(out_string, -(uint32_t)number, TRUE, width, padding);
+	}
+
+	return write_aligned(out_string, (uint32_t)number, FALSE, width, padding);
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* Valeur d'un chiffre hexadécimal, majuscule ou minuscule, ou NOT_A_DIGIT */
+static uint8_t hex_digit_value(char character){
+
+	if((character >= '0') && (character <= '9')){
+
+		return character - '0';
+	}
+
+	/* Mettre le bit 5 à 1 transforme une majuscule en minuscule */
+	character |= 0x20;
+
+	if((character >= 'a') && (character <= 'f')){
+
+		return character - 'a' + 0xA;
+	}
+
+	return NOT_A_DIGIT;
+}
+
+
+/* value = value * 10 + digit. Retourne FALSE, sans toucher value, si le
+résultat ne tient pas sur 32 bits. */
+static bool accumulate_decimal(uint32_t* value, uint8_t digit){
+
+	if((*value > UINT32_MAX_DIV10) || ((*value == UINT32_MAX_DIV10) && (digit > 5))){
+
+		return FALSE;
+	}
+
+	*value = (*value * 10) + digit;
+
+	return TRUE;
+}
+
+
+static bool accumulate_hex(uint32_t* value, uint8_t digit){
+
+	if(*value > 0x0FFFFFFF){
+
+		return FALSE;
+	}
+
+	*value = (*value << 4) | digit;
+
+	return TRUE;
+}
+
+
+/* Partie commune de la fin de parse_uint() et parse_hex_uint() */
+static uint32_t end_parse(const char* stop, uint32_t value, bool out_of_range, const char** end, bool* overflow){
+
+	if(out_of_range == TRUE){
+
+		value = UINT32_MAX;
+	}
+
+	/* Sans aucun chiffre, stop est le début de la string, comme avec strtoul() */
+	if(end != NULL){
+
+		*end = stop;
+	}
+
+	if(overflow != NULL){
+
+		*overflow = out_of_range;
+	}
+
+	return value;
+}
+
+
+/* Applique le signe en saturant à INT32_MIN ou INT32_MAX */
+static int32_t to_signed(uint32_t magnitude, bool negative, bool* out_of_range){
+
+	if(negative == TRUE){
+
+		if((*out_of_range == TRUE) || (magnitude > (uint32_t)INT32_MAX + 1)){
+
+			*out_of_range = TRUE;
+
+			return INT32_MIN;
+		}
+
+		/* Le - 1 puis + 1 évite de faire -(INT32_MIN) qui ne tient pas */
+		return -(int32_t)(magnitude - 1) - 1;
+	}
+
+	if((*out_of_range == TRUE) || (magnitude > INT32_MAX)){
+
+		*out_of_range = TRUE;
+
+		return INT32_MAX;
+	}
+
+	return (int32_t)magnitude;
+}
+
+
+/* Quotient par 10 d'un 32 bits avec seulement des décalages et des additions
+(Hacker's Delight, divu10). q est une approximation par défaut de n * 0.8 / 8,
+le reste sert à la corriger d'au plus 1. */
+static uint32_t div10_u32(uint32_t number){
+
+	uint32_t quotient;
+	uint32_t rest;
+
+	quotient = (number >> 1) + (number >> 2);
+	quotient += (quotient >> 4);
+	quotient += (quotient >> 8);
+	quotient += (quotient >> 16);
+	quotient >>= 3;
+
+	rest = number - ((quotient << 3) + (quotient << 1));
+
+	return quotient + (rest > 9);
+}
+
+
+/* Écrit les chiffres de number de droite à gauche en finissant juste avant end et
+retourne leur nombre (au moins 1). Dès que le nombre entre dans 16, puis dans
+8 bits, le reste se fait avec des multiplications plus petites. */
+static uint8_t write_digits(char* end, uint32_t number){
+
+	uint8_t count = 0;
+	uint32_t quotient_32;
+	uint16_t number_16;
+	uint16_t quotient_16;
+	uint8_t number_8;
+	uint8_t quotient_8;
+
+	while(number > 0xFFFF){
+
+		quotient_32 = div10_u32(number);
+
+		end--;
+		*end = '0' + (uint8_t)(number - ((quotient_32 << 3) + (quotient_32 << 1)));
+		count++;
+
+		number = quotient_32;
+	}
+
+	number_16 = (uint16_t)number;
+
+	while(number_16 > 0xFF){
+
+		quotient_16 = DIV10_U16(number_16);
+
+		end--;
+		*end = '0' + (uint8_t)(number_16 - quotient_16 * 10);
+		count++;
+
+		number_16 = quotient_16;
+	}
+
+	number_8 = (uint8_t)number_16;
+
+	do{
+
+		quotient_8 = DIV10_U8(number_8);
+
+		end--;
+		*end = '0' + (number_8 - quotient_8 * 10);
+		count++;
+
+		number_8 = quotient_8;
+
+	}while(number_8 > 0);
+
+	return count;
+}
+
+
+/* Le format des uintX_to_string() : width chiffres, complétés avec des 0 */
+static uint8_t write_fixed(char* out_string, uint32_t number, uint8_t width){
+
+	uint8_t i;
+
+	for(i = 0; i < width; i++){
+
+		out_string[i] = '0';
+	}
+
+	write_digits(&out_string[width], number);
+
+	out_string[width] = '\0';
+
+	return width;
+}
+
+
+/* Avec width à 0, le nombre prend juste la place qu'il lui faut */
+static uint8_t write_aligned(char* out_string, uint32_t magnitude, bool negative, uint8_t width, char padding){
+
+	char digits[UINT32_MAX_DIGITS];
+	uint8_t count;
+	uint8_t length;
+	uint8_t i = 0;
+
+	count = write_digits(&digits[UINT32_MAX_DIGITS], magnitude);
+
+	length = count + negative;
+
+	if(width == 0){
+
+		width = length;
+	}
+
+	if(length > width){
+
+		while(i < width){
+
+			out_string[i++] = OVERFLOW_CHAR;
+		}
+	}
+
+	else{
+
+		// Avec des 0, le signe va devant le remplissage : "-0042" et non "00-42"
+		if((negative == TRUE) && (padding == '0')){
+
+			out_string[i++] = '-';
+			negative = FALSE;
+		}
+
+		while(i < width - count - negative){
+
+			out_string[i++] = padding;
+		}
+
+		if(negative == TRUE){
+
+			out_string[i++] = '-';
+		}
+
+		mem_copy(&out_string[i], &digits[UINT32_MAX_DIGITS - count], count);
+	}
+
+	out_string[width] = '\0';
 
+	return width;
 }
@@ -58,6 +58,25 @@ typedef enum {
 #ifndef NULL
     #define NULL 0
 #endif
+
+
+/**
+    \brief État d'une conversion de texte en nombre qui reçoit ses caractères un à
+    la fois
+
+    Les champs ne devraient pas être modifiés directement.
+    \sa number_parser_feed()
+*/
+typedef struct{
+
+    uint32_t value;         ///< La valeur absolue accumulée jusqu'ici
+    uint8_t base;           ///< 10 ou 16
+    uint8_t digit_count;    ///< Le nombre de chiffres reçus (s'arrête à 255)
+    bool negative;          ///< Un '-' a été reçu
+    bool has_sign;          ///< Un '-' ou un '+' a été reçu
+    bool overflow;          ///< La valeur a dépassé 32 bits
+
+}number_parser_t;
 
 
 /* ----------------------------------------------------------------------------
@@ -277,8 +296,40 @@ Prototypes
     l'argument num devrait avoir la forme suivante :
 
         nb_elements * sizeof(element)
+
+    Les deux blocs ne doivent pas se chevaucher, sinon il faut utiliser mem_move().
 */
-void mem_copy(void * destination, const void * source, uint8_t num );
+void mem_copy(void * destination, const void * source, uint16_t num );
+
+/**
+    \brief Remplit un bloc de mémoire avec la même valeur
+    \param[out] destination Pointeur sur le début du bloc
+    \param[in]  value   La valeur de chaque byte
+    \param[in]  num     le nombre de byte à remplir
+*/
+void mem_set(void * destination, uint8_t value, uint16_t num );
+
+/**
+    \brief Compare deux blocs de mémoire byte par byte
+    \param[in]  block_1 Pointeur sur le premier bloc
+    \param[in]  block_2 Pointeur sur le deuxième bloc
+    \param[in]  num     le nombre de byte à comparer
+    \return 0 si les blocs sont identiques. Sinon, -1 ou 1 selon que le premier
+    byte qui diffère est plus petit ou plus grand dans block_1 (non signé).
+*/
+int8_t mem_compare(const void * block_1, const void * block_2, uint16_t num );
+
+/**
+    \brief Copie un bloc de mémoire à un autre endroit, même si les deux blocs se
+    chevauchent
+    \param[out] destination Pointeur sur la destination de la copie
+    \param[in]  source  Pointeur sur la source de la copie
+    \param[in]  num     le nombre de byte à copier
+
+    Un peu plus lent que mem_copy() quand la destination est après la source, parce
+    qu'il faut alors copier à partir de la fin.
+*/
+void mem_move(void * destination, const void * source, uint16_t num );
 
 
 /* String stuff *************************************************************/
@@ -340,6 +391,8 @@ uint32_t char_array_to_uint(const char* char_array, uint8_t size);
     \brief Converti un caractère représentant un chiffre hexadécimal en sa valeur
     \param[in]  character   Le caractère en question
     \return La valeur ou zéro si le caractère n'avait pas rapport
+
+    Les lettres de A à F sont acceptées en majuscule comme en minuscule.
 */
 uint8_t hex_char_to_uint(char character);
 
@@ -360,6 +413,125 @@ uint32_t hex_string_to_uint(const char* string);
     \return La valeur ou de la cochonnerie si le array n'avait pas rapport
 */
 uint32_t hex_char_array_to_uint(const char* char_array, uint8_t size);
+
+
+/**
+    \brief Converti le nombre décimal au début d'une string, comme strtoul()
+    \param[in]  string      La string en question
+    \param[out] end         Pointe sur le premier caractère qui n'a pas été converti.
+    Peut être NULL.
+    \param[out] overflow    TRUE si le nombre ne tient pas sur 32 bits. Peut être NULL.
+    \return La valeur, UINT32_MAX s'il y a eu un overflow ou 0 s'il n'y a aucun chiffre
+
+    La conversion se fait en une seule passe et s'arrête au premier caractère qui
+    n'est pas un chiffre. Les espaces au début ne sont pas sautés. Sans aucun
+    chiffre, end pointe sur string.
+
+    \code
+    const char* end;
+    bool overflow;
+    uint32_t speed;
+
+    speed = parse_uint(argument, &end, &overflow);
+
+    if((end == argument) || (*end != '\0') || (overflow == TRUE)){
+
+        // Pas un nombre valide
+    }
+    \endcode
+*/
+uint32_t parse_uint(const char* string, const char** end, bool* overflow);
+
+
+/**
+    \brief Converti le nombre hexadécimal au début d'une string, comme strtoul()
+    \param[in]  string      La string en question, sans "0x"
+    \param[out] end         Pointe sur le premier caractère qui n'a pas été converti.
+    Peut être NULL.
+    \param[out] overflow    TRUE si le nombre ne tient pas sur 32 bits. Peut être NULL.
+    \return La valeur, UINT32_MAX s'il y a eu un overflow ou 0 s'il n'y a aucun chiffre
+
+    Identique à parse_uint(), mais les lettres de A à F sont acceptées en majuscule
+    comme en minuscule.
+*/
+uint32_t parse_hex_uint(const char* string, const char** end, bool* overflow);
+
+
+/**
+    \brief Converti le nombre décimal signé au début d'une string, comme strtol()
+    \param[in]  string      La string en question
+    \param[out] end         Pointe sur le premier caractère qui n'a pas été converti.
+    Peut être NULL.
+    \param[out] overflow    TRUE si le nombre ne tient pas sur 32 bits signés. Peut
+    être NULL.
+    \return La valeur, INT32_MIN ou INT32_MAX s'il y a eu un overflow ou 0 s'il n'y a
+    aucun chiffre
+
+    Le nombre peut commencer par un '-' ou un '+'. Un signe qui n'est pas suivi d'un
+    chiffre n'est pas consommé : end pointe alors sur string.
+*/
+int32_t parse_int(const char* string, const char** end, bool* overflow);
+
+
+/**
+    \brief Prépare une conversion qui reçoit ses caractères un à la fois
+    \param[out] parser  La conversion à préparer
+    \param[in]  base    10 ou 16
+
+    Permet de convertir un nombre au fur et à mesure qu'il arrive, par exemple d'un
+    fifo, sans avoir à garder le texte au complet.
+
+    \code
+    number_parser_t parser;
+    int32_t position;
+
+    number_parser_init(&parser, 10);
+
+    while((fifo_is_empty(&rx_fifo) == FALSE) && (number_parser_feed(&parser, fifo_pop(&rx_fifo)) == TRUE)){
+
+    }
+
+    if(number_parser_get_int(&parser, &position) == TRUE){
+
+        // position est valide
+    }
+    \endcode
+*/
+void number_parser_init(number_parser_t* parser, uint8_t base);
+
+
+/**
+    \brief Ajoute un caractère à la conversion
+    \param[in,out] parser      La conversion
+    \param[in]     character   Le caractère reçu
+    \return FALSE si le caractère ne fait pas partie du nombre, qui est alors terminé
+
+    Un '-' ou un '+' est accepté une seule fois, avant le premier chiffre. Les
+    chiffres qui arrivent après un overflow sont acceptés, mais la valeur reste
+    invalide.
+*/
+bool number_parser_feed(number_parser_t* parser, char character);
+
+
+/**
+    \brief Retourne le résultat d'une conversion non signée
+    \param[in]  parser  La conversion
+    \param[out] value   La valeur, UINT32_MAX s'il y a eu un overflow
+    \return FALSE si aucun chiffre n'a été reçu, si le nombre est négatif ou s'il ne
+    tient pas sur 32 bits
+*/
+bool number_parser_get_uint(const number_parser_t* parser, uint32_t* value);
+
+
+/**
+    \brief Retourne le résultat d'une conversion signée
+    \param[in]  parser  La conversion
+    \param[out] value   La valeur, saturée à INT32_MIN ou INT32_MAX s'il y a eu un
+    overflow
+    \return FALSE si aucun chiffre n'a été reçu ou si le nombre ne tient pas sur 32
+    bits signés
+*/
+bool number_parser_get_int(const number_parser_t* parser, int32_t* value);
 
 
 /* Conversion number to text ************************************************/
@@ -666,5 +838,71 @@ uint8_t int16_to_string(char* out_string, int16_t number);
 */
 uint8_t int32_to_string(char* out_string, int32_t number);
 
+/**
+    \brief Converti un entier non signé en une string, sans remplissage
+    \param[out] out_string  La string de destination
+    \param[in]  number      Le nombre à convertir
+    \return     Le nombre de caractères ajoutés à la string sans compter le '\0'
+    \warning    La string doit pouvoir contenir 11 caractères dans le pire cas.
+
+    Le nombre prend seulement la place qu'il lui faut : 42 donne "42". Un uint8_t
+    ou un uint16_t peut être passé directement, la conversion est alors aussi
+    rapide qu'avec uint8_to_string() ou uint16_to_string().
+
+    Comme les autres fonctions *_to_string(), la conversion n'utilise aucune
+    division : le quotient par 10 se fait par une multiplication par l'inverse,
+    ce que l'AVR fait en quelques cycles avec l'instruction MUL.
+*/
+uint8_t uint32_to_string_unpadded(char* out_string, uint32_t number);
+
+/**
+    \brief Converti un entier signé en une string, sans remplissage
+    \param[out] out_string  La string de destination
+    \param[in]  number      Le nombre à convertir
+    \return     Le nombre de caractères ajoutés à la string sans compter le '\0'
+    \warning    La string doit pouvoir contenir 12 caractères dans le pire cas.
+
+    Le signe n'est ajouté que pour un nombre négatif : -42 donne "-42" et 42
+    donne "42".
+*/
+uint8_t int32_to_string_unpadded(char* out_string, int32_t number);
+
+/**
+    \brief Converti un entier non signé en une string de largeur fixe, alignée à
+    droite
+    \param[out] out_string  La string de destination
+    \param[in]  number      Le nombre à convertir
+    \param[in]  width       Le nombre de caractères de la string
+    \param[in]  padding     Le caractère qui complète à gauche, ' ' ou '0'
+    \return     width
+    \warning    La string doit pouvoir contenir width + 1 caractères.
+
+    Si le nombre ne tient pas dans width caractères, la string est remplie de '*'
+    plutôt que d'être tronquée. Pratique pour un champ d'un LCD, qui garde
+    toujours la même largeur.
+
+    \code
+
+    uint32_to_string_aligned(string, 42, 5, ' ');        // "   42"
+    uint32_to_string_aligned(string, 123456, 5, ' ');    // "*****"
+
+    \endcode
+*/
+uint8_t uint32_to_string_aligned(char* out_string, uint32_t number, uint8_t width, char padding);
+
+/**
+    \brief Converti un entier signé en une string de largeur fixe, alignée à droite
+    \param[out] out_string  La string de destination
+    \param[in]  number      Le nombre à convertir
+    \param[in]  width       Le nombre de caractères de la string, incluant le signe
+    \param[in]  padding     Le caractère qui complète à gauche, ' ' ou '0'
+    \return     width
+    \warning    La string doit pouvoir contenir width + 1 caractères.
+
+    Le signe n'est ajouté que pour un nombre négatif. Avec des espaces, il est
+    collé au nombre ("  -42"), avec des 0 il va au début ("-0042").
+*/
+uint8_t int32_to_string_aligned(char* out_string, int32_t number, uint8_t width, char padding);
+
 
 #endif // UTILS_H_INCLUDED
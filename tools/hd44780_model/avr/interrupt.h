@@ -0,0 +1,17 @@
+#ifndef MODEL_AVR_INTERRUPT_H_INCLUDED
+#define MODEL_AVR_INTERRUPT_H_INCLUDED
+
+/*
+	Remplace <avr/interrupt.h>. Le modèle n'exécute jamais d'interruption : en
+	mode LCD_ENABLE_ASYNC, les interruptions restant désactivées, la file est
+	vidée par l'appelant.
+*/
+
+#include <avr/io.h>
+
+#define ISR(vector) void vector(void)
+
+#define cli() (SREG &= (uint8_t)~(1 << SREG_I))
+#define sei() (SREG |= (1 << SREG_I))
+
+#endif // MODEL_AVR_INTERRUPT_H_INCLUDED
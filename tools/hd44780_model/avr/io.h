@@ -0,0 +1,36 @@
+#ifndef MODEL_AVR_IO_H_INCLUDED
+#define MODEL_AVR_IO_H_INCLUDED
+
+/*
+	Remplace <avr/io.h> pour compiler lib/lcd.c sur l'ordinateur. Chaque accès à
+	un registre passe par le modèle du HD44780, qui voit ainsi toutes les
+	transitions du bus. Voir hd44780_model.h.
+*/
+
+#include <stdint.h>
+#include "../hd44780_model.h"
+
+#define PORTA   (*model_register(MODEL_PORTA))
+#define PORTB   (*model_register(MODEL_PORTB))
+#define PORTC   (*model_register(MODEL_PORTC))
+#define PORTD   (*model_register(MODEL_PORTD))
+#define DDRA    (*model_register(MODEL_DDRA))
+#define DDRB    (*model_register(MODEL_DDRB))
+#define DDRC    (*model_register(MODEL_DDRC))
+#define DDRD    (*model_register(MODEL_DDRD))
+#define PINA    (*model_register(MODEL_PINA))
+#define PINB    (*model_register(MODEL_PINB))
+#define PINC    (*model_register(MODEL_PINC))
+#define PIND    (*model_register(MODEL_PIND))
+#define SREG    (*model_register(MODEL_SREG))
+#define TIMSK   (*model_register(MODEL_TIMSK))
+#define TCCR2   (*model_register(MODEL_TCCR2))
+#define OCR2    (*model_register(MODEL_OCR2))
+#define TCNT2   (*model_register(MODEL_TCNT2))
+
+#define SREG_I  7
+#define OCIE2   7
+#define WGM21   3
+#define CS21    1
+
+#endif // MODEL_AVR_IO_H_INCLUDED
@@ -0,0 +1,18 @@
+#ifndef MODEL_AVR_PGMSPACE_H_INCLUDED
+#define MODEL_AVR_PGMSPACE_H_INCLUDED
+
+/* Remplace <avr/pgmspace.h>. Sur l'ordinateur, la flash est de la RAM ordinaire. */
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(string) (string)
+
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define pgm_read_dword(address) (*(const uint32_t*)(address))
+#define pgm_read_ptr(address) (*(void* const*)(address))
+#define memcpy_P(destination, source, size) memcpy(destination, source, size)
+
+#endif // MODEL_AVR_PGMSPACE_H_INCLUDED
@@ -0,0 +1,572 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file hd44780_model.c
+	\brief Modèle du HD44780, pour l'ordinateur, qui vérifie le timing du bus
+	\author Iouri Savard Colbert
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hd44780_model.h"
+#include "lcd.h"
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+/* Doivent correspondre à DATA_PORT, DATA_DDR, DATA_PIN, CTRL_PORT et CTRL_DDR
+de lib/lcd.h */
+#define DATA_PORT_REG   MODEL_PORTC
+#define DATA_DDR_REG    MODEL_DDRC
+#define DATA_PIN_REG    MODEL_PINC
+#define CTRL_PORT_REG   MODEL_PORTA
+#define CTRL_DDR_REG    MODEL_DDRA
+
+#define ACCESS_NS ((uint64_t)MODEL_ACCESS_CYCLES * 1000000000ULL / F_CPU)
+
+/* Timing de la datasheet, avec l'oscillateur à 270 kHz */
+#define POWER_ON_NS     15000000ULL     // après que VCC ait atteint 4.5 V
+#define PWEH_NS         450ULL          // largeur minimale de E à 1
+#define TCYCE_NS        1000ULL         // période minimale de E
+#define LONG_EXEC_NS    1520000ULL      // clear display et return home
+#define EXEC_NS         37000ULL        // toutes les autres instructions
+#define TADD_NS         4000ULL         // mise à jour du compteur après une donnée
+
+#define DDRAM_SIZE 0x80
+#define CGRAM_SIZE 0x40
+#define LINE_SIZE 40
+
+#define BUSY_FLAG 0x80
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+static uint8_t registers[MODEL_NB_REGISTERS];
+static uint8_t pin_value;
+
+static uint64_t now;
+static uint64_t busy_until;
+static uint64_t last_rise;
+static int e_high;
+static int latched_rs;
+static int latched_rw;
+static uint8_t read_output;
+
+/* État interne du HD44780 */
+static uint8_t ddram[DDRAM_SIZE];
+static uint8_t cgram[CGRAM_SIZE];
+static uint8_t address;
+static int address_in_cgram;
+static int increment;
+static int shift_on_write;
+static int two_lines;
+static int display_shift;
+
+/* Statistiques */
+static uint32_t e_cycles;
+static uint32_t commands;
+static uint32_t data_count;
+static uint32_t violations;
+
+static const char* begin_label;
+static uint64_t begin_time;
+static uint32_t begin_e_cycles;
+static uint32_t begin_commands;
+static uint32_t begin_data_count;
+static uint32_t begin_violations;
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static void commit(void);
+static uint8_t output_pins(uint8_t reg);
+static void on_rising_edge(void);
+static void on_falling_edge(void);
+static void execute_command(uint8_t command);
+static void write_data(uint8_t data);
+static void move_address(void);
+static const char* command_name(uint8_t command);
+static void violation(const char* what, const char* detail);
+
+
+/******************************************************************************
+Global functions
+******************************************************************************/
+
+void model_reset(void){
+
+	memset(registers, 0, sizeof(registers));
+	memset(ddram, ' ', sizeof(ddram));
+	memset(cgram, 0, sizeof(cgram));
+
+	now = 0;
+	busy_until = POWER_ON_NS;
+	last_rise = 0;
+	e_high = 0;
+
+	address = 0;
+	address_in_cgram = 0;
+	increment = 1;
+	shift_on_write = 0;
+	two_lines = 0;
+	display_shift = 0;
+
+	e_cycles = 0;
+	commands = 0;
+	data_count = 0;
+	violations = 0;
+}
+
+
+volatile uint8_t* model_register(model_register_e reg){
+
+	commit();
+
+	now += ACCESS_NS;
+
+	switch(reg){
+	case MODEL_PINA:
+	case MODEL_PINB:
+	case MODEL_PINC:
+	case MODEL_PIND:
+		pin_value = output_pins(reg);
+		return &pin_value;
+
+	default:
+		return &registers[reg];
+	}
+}
+
+
+void model_delay_ns(uint64_t ns){
+
+	commit();
+
+	now += ns;
+}
+
+
+uint64_t model_get_time_ns(void){
+
+	return now;
+}
+
+
+uint32_t model_get_violation_count(void){
+
+	return violations;
+}
+
+
+void model_begin(const char* label){
+
+	commit();
+
+	begin_label = label;
+	begin_time = now;
+	begin_e_cycles = e_cycles;
+	begin_commands = commands;
+	begin_data_count = data_count;
+	begin_violations = violations;
+}
+
+
+void model_end(void){
+
+	commit();
+
+	printf("%-32s %10.1f us %6u E %6u cmd %6u data %4u viol\n",
+			begin_label,
+			(now - begin_time) / 1000.0,
+			e_cycles - begin_e_cycles,
+			commands - begin_commands,
+			data_count - begin_data_count,
+			violations - begin_violations);
+}
+
+
+uint8_t model_get_char(uint8_t col, uint8_t row){
+
+	static const uint8_t row_offsets[4] = {0x00, 0x40, 0x14, 0x54};
+	int column;
+
+	commit();
+
+	if(LCD_NB_ROW > 2){
+
+		return ddram[row_offsets[row] + col];
+	}
+
+	// Le décalage fait tourner chaque rangée sur ses 40 caractères
+	column = (col + display_shift) % LINE_SIZE;
+
+	if(column < 0){
+
+		column += LINE_SIZE;
+	}
+
+	return ddram[row_offsets[row] + column];
+}
+
+
+void model_print_display(void){
+
+	uint8_t row;
+	uint8_t col;
+	uint8_t character;
+
+	for(row = 0; row < LCD_NB_ROW; row++){
+
+		putchar('|');
+
+		for(col = 0; col < LCD_NB_COL; col++){
+
+			character = model_get_char(col, row);
+
+			if(character < 8){
+
+				putchar('0' + character);
+			}
+
+			else if((character >= ' ') && (character <= '}')){
+
+				putchar(character);
+			}
+
+			else{
+
+				putchar('?');
+			}
+		}
+
+		printf("|\n");
+	}
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* Regarde si E a changé depuis le dernier accès. Seules les broches en sortie
+comptent. */
+static void commit(void){
+
+	uint8_t ctrl;
+	int e;
+
+	ctrl = registers[CTRL_PORT_REG] & registers[CTRL_DDR_REG];
+	e = (ctrl >> E_PIN) & 1;
+
+	if((e == 1) && (e_high == 0)){
+
+		e_high = 1;
+		on_rising_edge();
+	}
+
+	else if((e == 0) && (e_high == 1)){
+
+		e_high = 0;
+		on_falling_edge();
+	}
+}
+
+
+static uint8_t output_pins(uint8_t reg){
+
+	// Le HD44780 pilote le bus pendant une lecture, si le port est en entrée
+	if((reg == DATA_PIN_REG) && (e_high == 1) && (latched_rw == 1) && (registers[DATA_DDR_REG] == 0x00)){
+
+		return read_output;
+	}
+
+	// Sinon, on lit ce que le microcontrôleur lui-même met sur les broches
+	return registers[reg - MODEL_PINA + MODEL_PORTA];
+}
+
+
+static void on_rising_edge(void){
+
+	uint8_t ctrl;
+
+	if((last_rise != 0) && (now - last_rise < TCYCE_NS)){
+
+		violation("tcycE", "cycle de E trop court");
+	}
+
+	last_rise = now;
+
+	ctrl = registers[CTRL_PORT_REG] & registers[CTRL_DDR_REG];
+	latched_rs = (ctrl >> RS_PIN) & 1;
+	latched_rw = (ctrl >> RW_PIN) & 1;
+
+	if(latched_rw == 1){
+
+		if(latched_rs == 0){
+
+			read_output = address & 0x7F;
+
+			if(now < busy_until){
+
+				read_output |= BUSY_FLAG;
+			}
+		}
+
+		else{
+
+			if(now < busy_until){
+
+				violation("busy", "lecture de donnée pendant que le HD44780 est occupé");
+			}
+
+			read_output = address_in_cgram ? cgram[address & 0x3F] : ddram[address & 0x7F];
+		}
+	}
+}
+
+
+static void on_falling_edge(void){
+
+	uint8_t data;
+
+	e_cycles++;
+
+	if(now - last_rise < PWEH_NS){
+
+		violation("PWEH", "impulsion de E trop courte");
+	}
+
+	if(latched_rw == 1){
+
+		// Une lecture de donnée avance le compteur comme une écriture
+		if(latched_rs == 1){
+
+			move_address();
+			busy_until = now + TADD_NS;
+		}
+
+		return;
+	}
+
+	data = registers[DATA_PORT_REG] & registers[DATA_DDR_REG];
+
+	if(now < POWER_ON_NS){
+
+		violation("power-on", latched_rs ? "donnée" : command_name(data));
+	}
+
+	else if(now < busy_until){
+
+		violation("busy", latched_rs ? "donnée" : command_name(data));
+	}
+
+	if(latched_rs == 0){
+
+		commands++;
+		execute_command(data);
+	}
+
+	else{
+
+		data_count++;
+		write_data(data);
+	}
+}
+
+
+static void execute_command(uint8_t command){
+
+	busy_until = now + EXEC_NS;
+
+	if(command & 0x80){
+
+		address = command & 0x7F;
+		address_in_cgram = 0;
+	}
+
+	else if(command & 0x40){
+
+		address = command & 0x3F;
+		address_in_cgram = 1;
+	}
+
+	else if(command & 0x20){
+
+		two_lines = (command >> 3) & 1;
+
+		if(((command >> 4) & 1) == 0){
+
+			violation("mode", "le modèle ne supporte que le bus de 8 bits");
+		}
+	}
+
+	else if(command & 0x10){
+
+		// S/C = 1 : décalage de l'affichage, sinon déplacement du curseur
+		if(command & 0x08){
+
+			display_shift += (command & 0x04) ? -1 : 1;
+		}
+
+		else{
+
+			increment = (command & 0x04) ? 1 : 0;
+			move_address();
+			increment = 1;
+		}
+	}
+
+	else if(command & 0x08){
+
+		// Display on/off control : rien à retenir pour le modèle
+	}
+
+	else if(command & 0x04){
+
+		increment = (command >> 1) & 1;
+		shift_on_write = command & 1;
+	}
+
+	else if(command & 0x02){
+
+		address = 0;
+		address_in_cgram = 0;
+		display_shift = 0;
+		busy_until = now + LONG_EXEC_NS;
+	}
+
+	else if(command & 0x01){
+
+		memset(ddram, ' ', sizeof(ddram));
+		address = 0;
+		address_in_cgram = 0;
+		increment = 1;
+		display_shift = 0;
+		busy_until = now + LONG_EXEC_NS;
+	}
+}
+
+
+static void write_data(uint8_t data){
+
+	if(address_in_cgram){
+
+		cgram[address & 0x3F] = data & 0x1F;
+	}
+
+	else{
+
+		ddram[address & 0x7F] = data;
+
+		if(shift_on_write){
+
+			display_shift += increment ? 1 : -1;
+		}
+	}
+
+	move_address();
+
+	busy_until = now + EXEC_NS + TADD_NS;
+}
+
+
+/* Avance ou recule le compteur d'adresse comme le HD44780, qui saute d'une
+rangée à l'autre au bout des 40 caractères */
+static void move_address(void){
+
+	if(address_in_cgram){
+
+		address = (address + (increment ? 1 : -1)) & 0x3F;
+	}
+
+	else if(two_lines){
+
+		if(increment){
+
+			address++;
+
+			if(address == 0x28){
+
+				address = 0x40;
+			}
+
+			else if(address == 0x68){
+
+				address = 0x00;
+			}
+		}
+
+		else{
+
+			if(address == 0x00){
+
+				address = 0x67;
+			}
+
+			else if(address == 0x40){
+
+				address = 0x27;
+			}
+
+			else{
+
+				address--;
+			}
+		}
+	}
+
+	else{
+
+		address = (address + (increment ? 1 : 2 * LINE_SIZE - 1)) % (2 * LINE_SIZE);
+	}
+}
+
+
+static const char* command_name(uint8_t command){
+
+	if(command & 0x80) return "set DDRAM address";
+	if(command & 0x40) return "set CGRAM address";
+	if(command & 0x20) return "function set";
+	if(command & 0x10) return "cursor or display shift";
+	if(command & 0x08) return "display on/off control";
+	if(command & 0x04) return "entry mode set";
+	if(command & 0x02) return "return home";
+	if(command & 0x01) return "clear display";
+
+	return "?";
+}
+
+
+static void violation(const char* what, const char* detail){
+
+	violations++;
+
+	printf("  [%10.1f us] violation %s : %s\n", now / 1000.0, what, detail);
+}
@@ -0,0 +1,159 @@
+#ifndef HD44780_MODEL_H_INCLUDED
+#define HD44780_MODEL_H_INCLUDED
+
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file hd44780_model.h
+	\brief Modèle du HD44780, pour l'ordinateur, qui vérifie le timing du bus
+	\author Iouri Savard Colbert
+
+	Ce modèle permet de compiler lib/lcd.c tel quel sur l'ordinateur. Les
+	en-têtes avr/io.h, avr/interrupt.h, avr/pgmspace.h et util/delay.h de ce
+	répertoire remplacent ceux d'avr-libc : chaque accès à un port passe par
+	model_register() et chaque délai fait avancer l'horloge du modèle.
+
+	Le modèle décode les fronts de E avec RS, RW et le bus de données, tient à
+	jour la DDRAM, la CGRAM, le compteur d'adresse et le décalage de l'affichage,
+	et signale toute violation de timing : instruction envoyée pendant que le
+	HD44780 est occupé, impulsion de E trop courte, cycle de E trop court ou
+	instruction envoyée avant la fin de la mise sous tension.
+
+	Le temps est compté en nanosecondes. Un accès à un registre coûte
+	MODEL_ACCESS_CYCLES cycles de F_CPU, ce qui est une approximation : le temps
+	des autres instructions du programme n'est pas compté.
+
+	Pour compiler le banc d'essai, à partir de la racine du dépôt :
+
+		gcc -O2 -DF_CPU=8000000UL -Itools/hd44780_model -Ilib -o lcd_bench \
+			tools/hd44780_model/lcd_bench.c tools/hd44780_model/hd44780_model.c \
+			lib/lcd.c lib/utils.c lib/fifo.c
+
+	Les switches de lcd.h (LCD_ENABLE_FRAMEBUFFER, par exemple) peuvent être
+	ajoutées avec -D pour comparer les modes.
+*/
+
+/* ----------------------------------------------------------------------------
+Includes
+---------------------------------------------------------------------------- */
+
+#include <stdint.h>
+
+
+/* ----------------------------------------------------------------------------
+Defines et typedef
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Nombre de cycles de F_CPU comptés pour chaque accès à un registre
+*/
+#define MODEL_ACCESS_CYCLES 2
+
+/**
+    \brief Les registres simulés
+*/
+typedef enum{
+
+	MODEL_PORTA,
+	MODEL_PORTB,
+	MODEL_PORTC,
+	MODEL_PORTD,
+	MODEL_DDRA,
+	MODEL_DDRB,
+	MODEL_DDRC,
+	MODEL_DDRD,
+	MODEL_PINA,
+	MODEL_PINB,
+	MODEL_PINC,
+	MODEL_PIND,
+	MODEL_SREG,
+	MODEL_TIMSK,
+	MODEL_TCCR2,
+	MODEL_OCR2,
+	MODEL_TCNT2,
+
+	MODEL_NB_REGISTERS
+
+}model_register_e;
+
+
+/* ----------------------------------------------------------------------------
+Prototypes
+---------------------------------------------------------------------------- */
+
+/**
+    \brief Remet le modèle à l'état de mise sous tension, au temps 0
+*/
+void model_reset(void);
+
+/**
+    \brief Accès à un registre, utilisé par les macros de avr/io.h
+
+	Les écritures faites par le programme sont vues par le modèle au prochain
+	accès, peu importe le registre. Comme chaque écriture est précédée d'un
+	accès, le modèle voit les états du bus un par un, dans l'ordre.
+*/
+volatile uint8_t* model_register(model_register_e reg);
+
+/**
+    \brief Fait avancer l'horloge du modèle, utilisé par util/delay.h
+*/
+void model_delay_ns(uint64_t ns);
+
+/**
+    \brief Retourne le temps écoulé depuis model_reset(), en nanosecondes
+*/
+uint64_t model_get_time_ns(void);
+
+/**
+    \brief Retourne le nombre de violations de timing depuis model_reset()
+*/
+uint32_t model_get_violation_count(void);
+
+/**
+    \brief Commence la mesure d'un appel
+    \param[in]  label   Le nom affiché par model_end()
+*/
+void model_begin(const char* label);
+
+/**
+    \brief Termine la mesure et affiche le temps, le nombre de cycles de E,
+	d'instructions, de données et de violations depuis model_begin()
+*/
+void model_end(void);
+
+/**
+    \brief Retourne le code de la ROM affiché à une position de l'écran
+    \param[in]  col     La colonne, de 0 à LCD_NB_COL - 1
+    \param[in]  row     La rangée, de 0 à LCD_NB_ROW - 1
+
+	Tient compte du décalage de l'affichage, comme model_print_display().
+*/
+uint8_t model_get_char(uint8_t col, uint8_t row);
+
+/**
+    \brief Affiche la partie visible de la DDRAM
+
+	Les caractères définis en CGRAM sont affichés comme leur numéro et les
+	caractères de la ROM qui ne sont pas ASCII comme un '?'.
+*/
+void model_print_display(void);
+
+
+#endif // HD44780_MODEL_H_INCLUDED
@@ -0,0 +1,284 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file lcd_bench.c
+	\brief Banc d'essai de lib/lcd.c sur le modèle du HD44780
+	\author Iouri Savard Colbert
+
+	Mesure le temps de bus des appels courants et vérifie qu'aucun ne viole le
+	timing du HD44780. Avec LCD_ENABLE_TEXT_MODULE, vérifie aussi le contenu de
+	l'écran après quelques éditions du sous-module text. Le programme retourne 1
+	s'il y a eu une violation ou une erreur d'affichage, ce qui permet de
+	l'utiliser dans un script. Voir hd44780_model.h pour le compiler.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <stdio.h>
+
+#include "hd44780_model.h"
+#include "lcd.h"
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+static const uint8_t smiley[HD44780_CGRAM_HEIGHT] = {
+
+	0x00, 0x0A, 0x0A, 0x00, 0x11, 0x0E, 0x00, 0x00
+};
+
+static uint32_t failures;
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static void write_fields(void);
+
+#ifdef LCD_ENABLE_TEXT_MODULE
+
+static void check_text_full_row_line_break(void);
+static void check_text_insert_in_row(void);
+static void settle(void);
+static void check_row(const char* label, uint8_t row, const char* expected);
+
+#endif
+
+#ifdef LCD_ENABLE_ASYNC
+
+/* La routine d'interruption de lib/lcd.c, une simple fonction avec le modèle */
+void TIMER2_COMP_vect(void);
+
+#endif
+
+
+/******************************************************************************
+Main
+******************************************************************************/
+
+int main(void){
+
+	model_reset();
+
+	model_begin("lcd_init");
+	lcd_init();
+	model_end();
+
+	model_begin("lcd_write_char");
+	lcd_write_char('A');
+	lcd_refresh();
+	model_end();
+
+	model_begin("lcd_write_string (16)");
+	lcd_write_string("Hello World 1234");
+	lcd_refresh();
+	model_end();
+
+	model_begin("lcd_set_cursor_position");
+	lcd_set_cursor_position(0, 0);
+	lcd_refresh();
+	model_end();
+
+	model_begin("lcd_write_string (32)");
+	lcd_write_string("Temperature: 21CHumidite:    45%");
+	lcd_refresh();
+	model_end();
+
+	model_begin("lcd_write_string (1 change)");
+	lcd_set_cursor_position(14, 0);
+	lcd_write_string("2");
+	lcd_refresh();
+	model_end();
+
+	model_begin("hd44780_write_cgram");
+	hd44780_write_cgram(0, smiley);
+	model_end();
+
+	model_begin("lcd_clear_display");
+	lcd_clear_display();
+	lcd_refresh();
+	model_end();
+
+	model_begin("lcd_write_string (UTF-8)");
+	lcd_write_string("Été à 25°C ");
+	lcd_write_char(0);
+	lcd_refresh();
+	model_end();
+
+	model_begin("4 champs");
+	write_fields();
+	lcd_refresh();
+	model_end();
+
+	model_begin("4 champs (transaction)");
+	lcd_begin();
+	write_fields();
+	lcd_end();
+	lcd_refresh();
+	model_end();
+
+	model_begin("hd44780_get_address");
+	hd44780_get_address();
+	model_end();
+
+	printf("\n");
+	model_print_display();
+
+#ifdef LCD_ENABLE_TEXT_MODULE
+
+	printf("\n");
+	check_text_full_row_line_break();
+	check_text_insert_in_row();
+
+#endif
+
+	printf("\n%.1f us au total, %u violation(s), %u erreur(s) d'affichage\n", model_get_time_ns() / 1000.0, model_get_violation_count(), failures);
+
+	return ((model_get_violation_count() == 0) && (failures == 0)) ? 0 : 1;
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+/* Mise à jour typique d'un écran : des champs placés un à la fois, dont certains
+se suivent et d'autres non */
+static void write_fields(void){
+
+	lcd_set_cursor_position(0, 1);
+	lcd_write_string("12");
+	lcd_set_cursor_position(2, 1);
+	lcd_write_string("34");
+	lcd_set_cursor_position(0, 0);
+	lcd_set_cursor_position(8, 1);
+	lcd_write_string("56");
+	lcd_shift_cursor(LCD_SHIFT_RIGHT);
+	lcd_write_string("78");
+}
+
+
+#ifdef LCD_ENABLE_TEXT_MODULE
+
+/* Une rangée remplie au complet envoie déjà la suite au début de la rangée
+suivante. Le '\n' tapé juste après ne doit pas sauter une autre rangée. */
+static void check_text_full_row_line_break(void){
+
+	char expected[LCD_NB_COL + 1];
+	uint8_t i;
+
+	// Ce qui reste du banc d'essai doit être parti avant de réinitialiser le LCD
+	settle();
+	text_init();
+
+	for(i = 0; i < LCD_NB_COL; i++){
+
+		expected[i] = 'A' + (i % 26);
+		text_write_char(expected[i]);
+	}
+
+	expected[LCD_NB_COL] = '\0';
+
+	text_line_break();
+	text_write_char('X');
+
+	settle();
+
+	check_row("text : rangée pleine puis '\\n'", 0, expected);
+	check_row("text : rangée pleine puis '\\n'", 1, "X");
+}
+
+
+/* Une insertion ou un effacement dans une rangée qui se termine par des espaces
+ne doit pas déplacer la rangée suivante */
+static void check_text_insert_in_row(void){
+
+	text_clear_display();
+	text_write_string("Hello\nWorld");
+
+	text_set_cursor_position(0, 0);
+	text_write_char('>');
+	settle();
+
+	check_row("text : insertion dans une rangée", 0, ">Hello");
+	check_row("text : insertion dans une rangée", 1, "World");
+
+	text_set_cursor_position(0, 0);
+	text_del_current_char();
+	settle();
+
+	check_row("text : effacement dans une rangée", 0, "Hello");
+	check_row("text : effacement dans une rangée", 1, "World");
+}
+
+
+/* Envoie au modèle tout ce qui est encore dans le framebuffer ou dans la file */
+static void settle(void){
+
+	lcd_refresh();
+
+#ifdef LCD_ENABLE_ASYNC
+
+	// Le modèle n'exécute pas d'interruption, on appelle la routine à la main,
+	// à toutes les LCD_TICK_US comme le ferait le timer 2
+	while(lcd_idle() == FALSE){
+
+		model_delay_ns(LCD_TICK_US * 1000ULL);
+		TIMER2_COMP_vect();
+	}
+
+#endif
+}
+
+
+/* Compare une rangée de l'écran à expected, complétée par des espaces */
+static void check_row(const char* label, uint8_t row, const char* expected){
+
+	uint8_t col;
+	uint8_t length;
+	char wanted;
+	bool ok = TRUE;
+
+	length = string_length(expected);
+
+	for(col = 0; col < LCD_NB_COL; col++){
+
+		wanted = (col < length) ? expected[col] : ' ';
+
+		if(model_get_char(col, row) != (uint8_t)wanted){
+
+			ok = FALSE;
+		}
+	}
+
+	printf("%-32s rangée %u : %s\n", label, row, (ok == TRUE) ? "ok" : "ERREUR");
+
+	if(ok == FALSE){
+
+		failures++;
+		model_print_display();
+	}
+}
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef MODEL_UTIL_DELAY_H_INCLUDED
+#define MODEL_UTIL_DELAY_H_INCLUDED
+
+/* Remplace <util/delay.h>. Les délais font avancer l'horloge du modèle. */
+
+#include "../hd44780_model.h"
+
+#define _delay_us(us) model_delay_ns((uint64_t)((us) * 1000.0))
+#define _delay_ms(ms) model_delay_ns((uint64_t)((ms) * 1000000.0))
+
+#endif // MODEL_UTIL_DELAY_H_INCLUDED
@@ -0,0 +1,478 @@
+/*
+	 __ ___  __
+	|_   |  (_
+	|__  |  __)
+
+	MIT License
+
+	Copyright (c) 2018	École de technologie supérieure
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify and/or merge copies of the Software, and to permit persons
+	to whom the Software is furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+*/
+/**
+	\file trace_decode.c
+	\brief Décodeur, pour l'ordinateur, des enregistrements du module lib/trace
+	\author Iouri Savard Colbert
+
+	Ce programme ne roule pas sur le microcontrôleur. Pour le compiler :
+
+		gcc -O2 -o trace_decode trace_decode.c
+
+	Utilisation :
+
+		trace_decode trace_messages.def [capture.bin]
+
+	Sans fichier de capture, les bytes sont lus sur l'entrée standard, ce qui
+	permet de décoder en direct, par exemple :
+
+		stty -F /dev/ttyUSB0 9600 raw && trace_decode trace_messages.def < /dev/ttyUSB0
+
+	Le numéro d'un message est sa position (à partir de 0) dans le fichier .def,
+	exactement comme l'enum généré du côté du microcontrôleur.
+*/
+
+/******************************************************************************
+Includes
+******************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+/******************************************************************************
+Defines
+******************************************************************************/
+
+/* Doivent correspondre à lib/trace.h */
+#define TRACE_SYNC_BYTE 0xA5
+#define TRACE_MAX_ARGS_SIZE 8
+
+#define MAX_MESSAGES 256
+#define MAX_FORMAT_SIZE 256
+#define MAX_LINE_SIZE 1024
+
+/* Sync, id, length, timestamp et arguments */
+#define MAX_RECORD_SIZE (5 + TRACE_MAX_ARGS_SIZE)
+
+
+/******************************************************************************
+Static variables
+******************************************************************************/
+
+static char* formats[MAX_MESSAGES];
+static int message_count;
+
+static FILE* capture;
+
+/* Bytes lus en trop qu'il faut relire lors d'une resynchronisation. L'entrée
+standard ne permet pas de reculer avec fseek. */
+static uint8_t pushback[MAX_RECORD_SIZE];
+static int pushback_count;
+
+
+/******************************************************************************
+Static prototypes
+******************************************************************************/
+
+static int read_byte(void);
+static void unread_bytes(const uint8_t* bytes, int count);
+static int read_bytes(uint8_t* bytes, int count);
+static int load_messages(const char* path);
+static int is_directive_or_comment(const char* line);
+static int parse_string_literal(const char* literal, char* out);
+static void print_record(uint8_t id, uint16_t timestamp, const uint8_t* args, uint8_t length);
+
+
+/******************************************************************************
+Main
+******************************************************************************/
+
+int main(int argc, char* argv[]){
+
+	uint8_t header[4];
+	uint8_t args[TRACE_MAX_ARGS_SIZE];
+	unsigned long skipped = 0;
+	int byte;
+
+	if((argc < 2) || (argc > 3)){
+
+		fprintf(stderr, "Utilisation : %s messages.def [capture.bin]\n", argv[0]);
+		return 1;
+	}
+
+	if(load_messages(argv[1]) != 0){
+
+		return 1;
+	}
+
+	capture = stdin;
+
+	if(argc == 3){
+
+		capture = fopen(argv[2], "rb");
+
+		if(capture == NULL){
+
+			perror(argv[2]);
+			return 1;
+		}
+	}
+
+	while((byte = read_byte()) != EOF){
+
+		/* Tout ce qui n'est pas un début d'enregistrement est du bruit ou un
+		enregistrement tronqué */
+		if(byte != TRACE_SYNC_BYTE){
+
+			skipped++;
+			continue;
+		}
+
+		/* id, length, timestamp */
+		if(read_bytes(header, 4) != 4){
+
+			break;
+		}
+
+		if(header[1] > TRACE_MAX_ARGS_SIZE){
+
+			/* Pas un vrai début d'enregistrement. On recule pour chercher le
+			prochain byte de sync dans ce qu'on vient de lire. */
+			skipped++;
+			unread_bytes(header, 4);
+			continue;
+		}
+
+		if(read_bytes(args, header[1]) != header[1]){
+
+			break;
+		}
+
+		if(skipped > 0){
+
+			printf("... %lu byte(s) ignore(s)\n", skipped);
+			skipped = 0;
+		}
+
+		print_record(header[0], (uint16_t)(header[2] | (header[3] << 8)), args, header[1]);
+	}
+
+	if(capture != stdin){
+
+		fclose(capture);
+	}
+
+	return 0;
+}
+
+
+/******************************************************************************
+Static functions
+******************************************************************************/
+
+static int read_byte(void){
+
+	if(pushback_count > 0){
+
+		pushback_count--;
+
+		return pushback[pushback_count];
+	}
+
+	return fgetc(capture);
+}
+
+
+/* Les bytes seront relus dans le même ordre */
+static void unread_bytes(const uint8_t* bytes, int count){
+
+	while(count > 0){
+
+		count--;
+
+		pushback[pushback_count] = bytes[count];
+		pushback_count++;
+	}
+}
+
+
+static int read_bytes(uint8_t* bytes, int count){
+
+	int i;
+	int byte;
+
+	for(i = 0; i < count; i++){
+
+		byte = read_byte();
+
+		if(byte == EOF){
+
+			break;
+		}
+
+		bytes[i] = (uint8_t)byte;
+	}
+
+	return i;
+}
+
+
+/* Lit toutes les lignes TRACE_MESSAGE(NOM, "format") du fichier .def */
+static int load_messages(const char* path){
+
+	FILE* file;
+	char line[MAX_LINE_SIZE];
+	char format[MAX_FORMAT_SIZE];
+	char* ptr;
+
+	file = fopen(path, "r");
+
+	if(file == NULL){
+
+		perror(path);
+		return -1;
+	}
+
+	while(fgets(line, sizeof(line), file) != NULL){
+
+		ptr = strstr(line, "TRACE_MESSAGE(");
+
+		/* Les lignes de #define, #undef et les commentaires ne nous intéressent pas.
+		Un '#' ailleurs dans la ligne peut faire partie du format ("%#x"). */
+		if((ptr == NULL) || (is_directive_or_comment(line) == 1)){
+
+			continue;
+		}
+
+		ptr = strchr(ptr, ',');
+
+		if((ptr == NULL) || ((ptr = strchr(ptr, '"')) == NULL)){
+
+			fprintf(stderr, "%s : ligne invalide : %s", path, line);
+			fclose(file);
+			return -1;
+		}
+
+		if(parse_string_literal(ptr, format) != 0){
+
+			fprintf(stderr, "%s : string invalide : %s", path, line);
+			fclose(file);
+			return -1;
+		}
+
+		if(message_count >= MAX_MESSAGES){
+
+			fprintf(stderr, "%s : plus de %d messages\n", path, MAX_MESSAGES);
+			fclose(file);
+			return -1;
+		}
+
+		formats[message_count] = strdup(format);
+		message_count++;
+	}
+
+	fclose(file);
+
+	return 0;
+}
+
+
+/* 1 si le premier caractère non blanc de la ligne commence une directive du
+préprocesseur ou un commentaire */
+static int is_directive_or_comment(const char* line){
+
+	while(isspace((unsigned char)*line)){
+
+		line++;
+	}
+
+	if(*line == '#'){
+
+		return 1;
+	}
+
+	if((line[0] == '/') && ((line[1] == '/') || (line[1] == '*'))){
+
+		return 1;
+	}
+
+	return 0;
+}
+
+
+/* Converti un littéral C (avec ses guillemets) en string. Seules les séquences
+d'échappement courantes sont supportées. */
+static int parse_string_literal(const char* literal, char* out){
+
+	int length = 0;
+
+	/* On saute le guillemet ouvrant */
+	literal++;
+
+	while(*literal != '"'){
+
+		if((*literal == '\0') || (length >= MAX_FORMAT_SIZE - 1)){
+
+			return -1;
+		}
+
+		if(*literal == '\\'){
+
+			literal++;
+
+			switch(*literal){
+			case 'n':	out[length] = '\n';		break;
+			case 'r':	out[length] = '\r';		break;
+			case 't':	out[length] = '\t';		break;
+			default:	out[length] = *literal;	break;
+			}
+		}
+
+		else{
+
+			out[length] = *literal;
+		}
+
+		length++;
+		literal++;
+	}
+
+	out[length] = '\0';
+
+	return 0;
+}
+
+
+/* Reproduit printf avec les tailles d'un AVR : un int fait 16 bits */
+static void print_record(uint8_t id, uint16_t timestamp, const uint8_t* args, uint8_t length){
+
+	const char* format;
+	char spec[32];
+	int spec_length;
+	int size;
+	int offset = 0;
+	uint32_t raw;
+	int64_t value;
+	int i;
+
+	printf("[%5u] ", timestamp);
+
+	if(id >= message_count){
+
+		printf("message inconnu %u (%u bytes)\n", id, length);
+		return;
+	}
+
+	format = formats[id];
+
+	while(*format != '\0'){
+
+		if(*format != '%'){
+
+			putchar(*format);
+			format++;
+			continue;
+		}
+
+		if(format[1] == '%'){
+
+			putchar('%');
+			format += 2;
+			continue;
+		}
+
+		/* On copie les flags et la largeur tels quels */
+		spec_length = 0;
+		spec[spec_length++] = *format++;
+
+		while((strchr("-+ #0123456789.", *format) != NULL) && (*format != '\0') && (spec_length < 20)){
+
+			spec[spec_length++] = *format++;
+		}
+
+		/* Taille de l'argument sur AVR */
+		size = 2;
+
+		if((format[0] == 'h') && (format[1] == 'h')){
+
+			size = 1;
+			format += 2;
+		}
+
+		else if(format[0] == 'h'){
+
+			format++;
+		}
+
+		else if(format[0] == 'l'){
+
+			size = 4;
+			format++;
+		}
+
+		if(*format == 'c'){
+
+			size = 1;
+		}
+
+		if(offset + size > length){
+
+			printf("<argument manquant>");
+			break;
+		}
+
+		raw = 0;
+
+		for(i = 0; i < size; i++){
+
+			raw |= (uint32_t)args[offset + i] << (8 * i);
+		}
+
+		offset += size;
+
+		/* Extension du signe pour %d et %i */
+		if((*format == 'd') || (*format == 'i')){
+
+			value = (int32_t)(raw << (32 - 8 * size)) >> (32 - 8 * size);
+		}
+
+		else{
+
+			value = raw;
+		}
+
+		spec[spec_length++] = 'l';
+		spec[spec_length++] = 'l';
+		spec[spec_length++] = *format;
+		spec[spec_length] = '\0';
+
+		if(*format == 'c'){
+
+			spec[spec_length - 3] = 'c';
+			spec[spec_length - 2] = '\0';
+			printf(spec, (int)value);
+		}
+
+		else{
+
+			printf(spec, (long long)value);
+		}
+
+		if(*format != '\0'){
+
+			format++;
+		}
+	}
+
+	putchar('\n');
+}